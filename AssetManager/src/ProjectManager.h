@@ -95,6 +95,14 @@ public:
 				openPkg = nullptr;
 				ROSE_GETSYSTEM(ProjectLoader).UnloadProject();
 			}
+			//0 loads package textures one by one, above 0 packs them into atlas pages of that size
+			auto project = ROSE_GETSYSTEM(ProjectLoader).GetCurrentProject();
+			if (project != nullptr) {
+				int atlasPageSize = project->GetAtlasPageSize();
+				if (ImGui::InputInt("Atlas page size", &atlasPageSize, 256, 1024)) {
+					project->SetAtlasPageSize(atlasPageSize);
+				}
+			}
 			if (ImGui::BeginListBox("Project packages")) {
 				for (auto pkg : projectPackages) {
 					bool selected = selectedProjectPkg == pkg;
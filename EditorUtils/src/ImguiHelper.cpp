@@ -16,13 +16,13 @@ static int ResizeStringCallback(ImGuiInputTextCallbackData* data)
 }
 
 
-void Imgui_InputText(const char* label, std::string& buffer, int length, ImGuiInputTextFlags flags)
+bool Imgui_InputText(const char* label, std::string& buffer, int length, ImGuiInputTextFlags flags)
 {
 	if(buffer.capacity() < length + 1)
 	{
 		buffer.reserve(length + 1);
 	}
-	ImGui::InputText(label, &buffer[0], length + 1, ImGuiInputTextFlags_CallbackResize, ResizeStringCallback, &buffer);
+	return ImGui::InputText(label, &buffer[0], length + 1, ImGuiInputTextFlags_CallbackResize, ResizeStringCallback, &buffer);
 }
 
 
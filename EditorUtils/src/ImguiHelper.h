@@ -8,5 +8,5 @@
 
 typedef std::pair<std::string, AssetHandle> AssetInfo;
 
-void Imgui_InputText(const char* label, std::string& buffer, int length, ImGuiInputTextFlags flags = 0);
+bool Imgui_InputText(const char* label, std::string& buffer, int length, ImGuiInputTextFlags flags = 0);
 void Imgui_AssetDropDown(const std::string& label, AssetType assetType, std::function<void(AssetInfo&)> func);
\ No newline at end of file
@@ -6,6 +6,9 @@
 #ifdef _EDITOR
 #include "Editor/Editor.h"
 #else
+#include <cstring>
+#include <cstdlib>
+
 #include "Runtime/Core/Game.h"
 #endif // _EDITOR
 
@@ -17,7 +20,27 @@ int main(int argc, char* argv[])
 #ifdef _EDITOR
 	app = new Editor();
 #else
-	app = new Game();
+	GameOptions options;
+	for(int i = 1; i < argc; i++)
+	{
+		if(std::strcmp(argv[i], "--headless") == 0)
+		{
+			options.headless = true;
+		} else if(std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+		{
+			options.frameCount = std::atoi(argv[++i]);
+		} else if(std::strcmp(argv[i], "--dump-frames") == 0 && i + 1 < argc)
+		{
+			options.frameDumpPath = argv[++i];
+		} else if(std::strcmp(argv[i], "--timings") == 0 && i + 1 < argc)
+		{
+			options.timingsPath = argv[++i];
+		} else if(std::strcmp(argv[i], "--pipelined-render") == 0)
+		{
+			options.pipelinedRendering = true;
+		}
+	}
+	app = new Game(options);
 #endif
 
 	app->Run();
@@ -14,9 +14,16 @@
 template<typename T>
 class DefaultTypeEditor
 {
+	//Typing or dragging only counts once the widget lets go, single clicks count right away
+	static bool EditFinished(bool changed)
+	{
+		return ImGui::IsItemDeactivatedAfterEdit() || (changed && !ImGui::IsItemActive());
+	}
 public:
-	static void Render(int entity, T* object)
+	//Returns true when an edit was finished this frame, the object itself is updated while editing
+	static bool Render(int entity, T* object)
 	{
+		bool finished = false;
 		Reflector<T> m;
 		ImGui::PushID(entity);
 		for(auto& varName : m.GetVarNames())
@@ -27,28 +34,28 @@ public:
 			}
 			if(m.GetType(varName) == InfoTypes::INT)
 			{
-				ImGui::InputInt(varName.c_str(), (int*)m.GetVar(object, varName));
+				finished |= EditFinished(ImGui::InputInt(varName.c_str(), (int*)m.GetVar(object, varName)));
 			}
 			if(m.GetType(varName) == InfoTypes::STRING)
 			{
 				auto& str = *(std::string*)m.GetVar(object, varName);
-				Imgui_InputText(varName.c_str(), str, 30);
+				finished |= EditFinished(Imgui_InputText(varName.c_str(), str, 30));
 			}
 			if(m.GetType(varName) == InfoTypes::COLOR)
 			{
-				ImGui::ColorEdit4(varName.c_str(), (float*)m.GetVar(object, varName), ImGuiColorEditFlags_AlphaBar | ImGuiColorEditFlags_Float);
+				finished |= EditFinished(ImGui::ColorEdit4(varName.c_str(), (float*)m.GetVar(object, varName), ImGuiColorEditFlags_AlphaBar | ImGuiColorEditFlags_Float));
 			}
 			if(m.GetType(varName) == InfoTypes::FLOAT)
 			{
-				ImGui::InputFloat(varName.c_str(), (float*)m.GetVar(object, varName));
+				finished |= EditFinished(ImGui::InputFloat(varName.c_str(), (float*)m.GetVar(object, varName)));
 			}
 			if(m.GetType(varName) == InfoTypes::VEC2)
 			{
-				ImGui::InputFloat2(varName.c_str(), (float*)m.GetVar(object, varName));
+				finished |= EditFinished(ImGui::InputFloat2(varName.c_str(), (float*)m.GetVar(object, varName)));
 			}
 			if(m.GetType(varName) == InfoTypes::BOOL)
 			{
-				ImGui::Checkbox(varName.c_str(), (bool*)m.GetVar(object, varName));
+				finished |= EditFinished(ImGui::Checkbox(varName.c_str(), (bool*)m.GetVar(object, varName)));
 			}
 			if(m.GetType(varName) == InfoTypes::GUID)
 			{
@@ -56,6 +63,7 @@ public:
 			}
 		}
 		ImGui::PopID();
+		return finished;
 	}
 };
 
@@ -71,7 +79,12 @@ public:
 
 	void Editor(entt::entity entity) override
 	{
-		T& component = ROSE_GETSYSTEM(EntitySystem).GetRegistry().get<T>(entity);
-		DefaultTypeEditor<T>::Render((int)entity, &component);
+		auto& registry = ROSE_GETSYSTEM(EntitySystem).GetRegistry();
+		T& component = registry.get<T>(entity);
+		//Patching runs the update hooks, e.g. renaming reparents in TransformSystem, so only once per finished edit
+		if(DefaultTypeEditor<T>::Render((int)entity, &component))
+		{
+			registry.patch<T>(entity);
+		}
 	}
 };
\ No newline at end of file
@@ -120,6 +120,7 @@ void Editor::Update()
 		ROSE_GETSYSTEM(ScriptSystem).Update();
 		ROSE_GETSYSTEM(EntityEventSystem).Update();
 	}
+	ROSE_GETSYSTEM(EntitySystem).FlushCommands();
 
 	if(!ROSE_GETSYSTEM(ImguiSystem).IsMouseCaptured())
 	{
@@ -181,8 +182,10 @@ void Editor::UpdateViewportControls()
 			}
 			if(input.GetMouseButton(LEFT_BUTTON).isPressed)
 			{
-				registry.get<TransformComponent>(createdEntity).globalPosition = glm::vec2(mousePos.x, mousePos.y);
-				registry.get<TransformComponent>(createdEntity).UpdateLocals();
+				auto& trx = registry.get<TransformComponent>(createdEntity);
+				trx.globalPosition = glm::vec2(mousePos.x, mousePos.y);
+				trx.UpdateLocals();
+				ROSE_GETSYSTEM(TransformSystem).MarkDirty(createdEntity);
 			}
 		}
 	}
@@ -239,6 +242,17 @@ void Editor::UpdateGlobalControls()
 				levelTreeEditor.SelectEntity(ROSE_GETSYSTEM(EntitySystem).CopyEntity(GetSelectedEntity()));
 			}
 		}
+		if(input.GetKey(InputKey::P).justPressed)
+		{
+			if(GetSelectedEntity() != NoEntity())
+			{
+				auto fileName = ROSE_GETSYSTEM(FileDialog).SaveFile("prefab");
+				if(fileName != "")
+				{
+					levelLoader.SavePrefab(GetSelectedEntity(), fileName);
+				}
+			}
+		}
 		return;
 	}
 	static vec2 lastPos;
@@ -711,6 +725,17 @@ void Editor::RenderTools()
 		}
 		ImGui::SameLine();
 	}
+	{
+		auto stats = gameRenderer.GetBatchStats();
+		ImGui::Text("Sprites: %d Draw Calls: %d Saved: %d", stats.sprites, stats.drawCalls, stats.GetSavedDrawCalls());
+		auto physicsStats = ROSE_GETSYSTEM(PhysicsSystem).GetStats();
+		ImGui::Text("Bodies: %d Teleported: %d Synced: %d Steps: %d Contacts: %d", physicsStats.bodies, physicsStats.teleported, physicsStats.synced, physicsStats.steps, physicsStats.contacts);
+		bool parallelVertices = gameRenderer.IsParallelVertexGeneration();
+		if(ImGui::Checkbox("Parallel Vertices", &parallelVertices))
+		{
+			gameRenderer.SetParallelVertexGeneration(parallelVertices);
+		}
+	}
 
 	ImGui::EndTable();
 }
@@ -34,15 +34,15 @@ void LevelTreeEditor::ShowEntity(entt::registry& registry)
 	}
 }
 
-void LevelTreeEditor::EditorChildren(entt::registry& registry, Node<entt::entity>* node)
+void LevelTreeEditor::EditorChildren(entt::registry& registry, LevelTree& levelTree, entt::entity entity)
 {
-	const auto& guid = registry.get<GUIDComponent>(node->element);
-	const auto& trx = registry.get<TransformComponent>(node->element);
-	auto disabled = registry.try_get<DisableComponent>(node->element);
+	const auto& guid = registry.get<GUIDComponent>(entity);
+	const auto& trx = registry.get<TransformComponent>(entity);
+	auto disabled = registry.try_get<DisableComponent>(entity);
 	ImGuiTreeNodeFlags flags = ImGuiTreeNodeFlags_OpenOnArrow
 		| ImGuiTreeNodeFlags_OpenOnDoubleClick
-		| (node->element == selectedEntity ? ImGuiTreeNodeFlags_Selected : 0)
-		| (node->children.size() == 0 ? ImGuiTreeNodeFlags_Leaf : 0);
+		| (entity == selectedEntity ? ImGuiTreeNodeFlags_Selected : 0)
+		| (levelTree.GetChildCount(entity) == 0 ? ImGuiTreeNodeFlags_Leaf : 0);
 
 	bool open = false;
 
@@ -67,7 +67,7 @@ void LevelTreeEditor::EditorChildren(entt::registry& registry, Node<entt::entity
 
 	if(ImGui::BeginDragDropSource())
 	{
-		ImGui::SetDragDropPayload("Node<entt::entity>", &(node->element), sizeof(node->element));
+		ImGui::SetDragDropPayload("Node<entt::entity>", &entity, sizeof(entity));
 		ImGui::Text(std::to_string(guid.id).c_str());
 		ImGui::EndDragDropSource();
 	}
@@ -75,22 +75,22 @@ void LevelTreeEditor::EditorChildren(entt::registry& registry, Node<entt::entity
 	{
 		if(const ImGuiPayload* payload = ImGui::AcceptDragDropPayload("Node<entt::entity>"))
 		{
-			auto entity = (entt::entity*)(payload->Data);
-			currentCommand.child = *entity;
-			currentCommand.newParent = node->element;
+			auto droppedEntity = (entt::entity*)(payload->Data);
+			currentCommand.child = *droppedEntity;
+			currentCommand.newParent = entity;
 		}
 		ImGui::EndDragDropTarget();
 	}
 
 	if(ImGui::IsItemClicked())
 	{
-		selectedEntity = node->element;
+		selectedEntity = entity;
 	}
 	if(open)
 	{
-		for(auto node : node->children)
+		for(auto child = levelTree.GetFirstChild(entity); child != NoEntity(); child = levelTree.GetNextSibling(child))
 		{
-			EditorChildren(registry, node);
+			EditorChildren(registry, levelTree, child);
 		}
 		ImGui::TreePop();
 	}
@@ -101,9 +101,9 @@ void LevelTreeEditor::Editor()
 	auto& registry = ROSE_GETSYSTEM(EntitySystem).GetRegistry();
 	ShowEntity(registry);
 	auto& levelTree = ROSE_GETSYSTEM(LevelTree);
-	for(auto node : levelTree.GetRoot()->children)
+	for(auto child = levelTree.GetFirstChild(NoEntity()); child != NoEntity(); child = levelTree.GetNextSibling(child))
 	{
-		EditorChildren(registry, node);
+		EditorChildren(registry, levelTree, child);
 	}
 	if(currentCommand.child != entt::entity(-1))
 	{
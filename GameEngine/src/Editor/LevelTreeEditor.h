@@ -16,7 +16,7 @@ class LevelTreeEditor {
 	ChildCommand currentCommand;
 	entt::entity selectedEntity;
 	void ShowEntity(entt::registry& registry);
-	void EditorChildren(entt::registry& registry, Node<entt::entity>* node);
+	void EditorChildren(entt::registry& registry, LevelTree& levelTree, entt::entity entity);
 public:
 	LevelTreeEditor();
 	void Editor();
@@ -8,6 +8,7 @@
 #include "Core/Systems.h"
 
 #include "Components/TransformComponent.h"
+#include "Core/Transform.h"
 #include <Core/Log.h>
 
 class MoveTool
@@ -50,7 +51,7 @@ public:
 		auto& renderSystem = ROSE_GETSYSTEM(RendererSystem);
 		auto matrix = renderSystem.GetWorldToScreenMatrix();
 		auto& trx = ROSE_GETSYSTEM(EntitySystem).GetComponent<TransformComponent>(entity);
-		auto orig = TransformComponent::GetPosition(trx.matrixL2W * matrix, vec2(0, 0));
+		auto orig = TransformComponent::GetPosition(trx.matrixL2W.ToMat3() * matrix, vec2(0, 0));
 		auto xAxis = orig + vec2(100, 0);
 		xAxisGizmos = {orig.x,orig.y - 8, 100, 16};
 		auto yAxis = orig + vec2(0, -100);
@@ -130,6 +131,7 @@ public:
 				}
 				trx.globalPosition = entityStartPos + translate;
 				trx.UpdateLocals();
+				ROSE_GETSYSTEM(TransformSystem).MarkDirty(entity);
 			} else
 			{
 				isMovingX = false;
@@ -91,6 +91,16 @@ public:
 				phys.body->SetType(phys.bodyDef.type);
 			}
 		}
+		if(ImGui::SliderInt("Layer", &phys.layer, 0, 15))
+		{
+			phys.fixture.filter.categoryBits = PhysicsSystem::LayerBit(phys.layer);
+			if(phys.body != nullptr)
+			{
+				auto filter = phys.body->GetFixtureList()[0].GetFilterData();
+				filter.categoryBits = phys.fixture.filter.categoryBits;
+				phys.body->GetFixtureList()[0].SetFilterData(filter);
+			}
+		}
 		if(ImGui::Checkbox("Use Gravity", &phys.useGravity))
 		{
 			if(phys.body != nullptr)
@@ -8,6 +8,7 @@
 #include "Core/Systems.h"
 
 #include "Components/TransformComponent.h"
+#include "Core/Transform.h"
 #include <Core/Log.h>
 
 class RotateTool
@@ -51,7 +52,7 @@ public:
 		auto& renderSystem = ROSE_GETSYSTEM(RendererSystem);
 		auto matrix = renderSystem.GetWorldToScreenMatrix();
 		auto& trx = ROSE_GETSYSTEM(EntitySystem).GetComponent<TransformComponent>(entity);
-		auto orig = TransformComponent::GetPosition(trx.matrixL2W * matrix, vec2(0, 0));
+		auto orig = TransformComponent::GetPosition(trx.matrixL2W.ToMat3() * matrix, vec2(0, 0));
 		gizmosCenter = orig;
 		gizmosRadius = 75;
 		if(isRotating)
@@ -105,6 +106,7 @@ public:
 					trx.globalRotation = entityStartRot - (angle - mouseStartRot);
 				}
 				trx.UpdateLocals();
+				ROSE_GETSYSTEM(TransformSystem).MarkDirty(entity);
 
 			} else
 			{
@@ -18,6 +18,7 @@ AnimationSystem::AnimationSystem()
 {
 	entt::registry& registry = ROSE_GETSYSTEM(EntitySystem).GetRegistry();
 	registry.on_destroy<AnimationComponent>().connect<&AnimationSystem::AnimationDestroyed>(this);
+	registry.on_update<AnimationComponent>().connect<&AnimationSystem::AnimationChanged>(this);
 }
 
 void AnimationSystem::Update()
@@ -33,7 +34,7 @@ void AnimationSystem::Update()
 		auto& animationComponent = view.get<AnimationComponent>(entity);
 		auto& spriteComponent = view.get<SpriteComponent>(entity);
 		animationComponent.Update(dt);
-		auto animationHandle = assetStore.GetAsset(animationComponent.animation);
+		auto animationHandle = assetStore.GetAsset(animationComponent.animationId);
 		if(animationHandle.type != AssetType::Animation)
 		{
 			continue;
@@ -43,7 +44,12 @@ void AnimationSystem::Update()
 		{
 			continue;
 		}
-		spriteComponent.sprite = animation->texture;
+		auto textureId = assetStore.GetCurrentId(animation->textureId);
+		if(spriteComponent.spriteId != textureId)
+		{
+			spriteComponent.sprite = animation->texture;
+			spriteComponent.spriteId = textureId;
+		}
 		spriteComponent.sourceRectData = animation->GetSourceRect(animationComponent.currentFrame);
 		spriteComponent.sourceRect = &spriteComponent.sourceRectData;
 		while(animationComponent.IsEventQueued())
@@ -66,3 +72,9 @@ void AnimationSystem::AnimationDestroyed(entt::registry& registry, entt::entity
 		spriteComponent.sourceRect = nullptr;
 	}
 }
+
+void AnimationSystem::AnimationChanged(entt::registry& registry, entt::entity entity)
+{
+	auto& animationComponent = registry.get<AnimationComponent>(entity);
+	animationComponent.animationId = ROSE_GETSYSTEM(AssetStore).GetAssetId(animationComponent.animation);
+}
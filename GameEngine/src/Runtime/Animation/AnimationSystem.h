@@ -16,4 +16,5 @@ public:
 	AnimationSystem();
 	void Update();
 	void AnimationDestroyed(entt::registry& registry, entt::entity entity);
+	void AnimationChanged(entt::registry& registry, entt::entity entity);
 };
\ No newline at end of file
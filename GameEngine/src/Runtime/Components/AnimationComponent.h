@@ -14,6 +14,8 @@
 struct AnimationComponent
 {
 	std::string animation;
+	//Interned id of animation, resolved when the name is set
+	AssetId animationId;
 
 	float currentFrameTime;
 	int currentFrame;
@@ -39,6 +41,7 @@ struct AnimationComponent
 	AnimationComponent(std::string animaiton = "")
 	{
 		this->animation = animaiton;
+		this->animationId = ROSE_GETSYSTEM(AssetStore).GetAssetId(animaiton);
 		Reset();
 	}
 
@@ -47,12 +50,20 @@ struct AnimationComponent
 		Reset();
 		this->animation = "";
 		ROSE_DESER(AnimationComponent);
+		this->animationId = ROSE_GETSYSTEM(AssetStore).GetAssetId(animation);
 	}
 
 	void Update(float dt)
 	{
 		AssetStore& assetStore = ROSE_GETSYSTEM(AssetStore);
-		auto animationHandle = assetStore.GetAsset(animation);
+		//The animation was loaded or replaced since the id was taken, its frames may have changed
+		auto currentId = assetStore.GetCurrentId(animationId);
+		if(currentId != animationId)
+		{
+			animationId = currentId;
+			Reset();
+		}
+		auto animationHandle = assetStore.GetAsset(animationId);
 		if(animationHandle.type != AssetType::Animation)
 		{
 			return;
@@ -127,6 +138,7 @@ struct AnimationComponent
 	void Play(const std::string& animation)
 	{
 		this->animation = animation;
+		this->animationId = ROSE_GETSYSTEM(AssetStore).GetAssetId(animation);
 		Reset();
 	}
 	void Serialize(ryml::NodeRef node)
@@ -15,8 +15,18 @@ struct PhysicsBodyComponent
 	bool isStatic;
 	bool isSensor;
 	bool useGravity;
+	//Collision layer 0-15, queries filter bodies with a mask of layer bits
+	int layer;
 
 	vec2 globalSize;
+	//Transform version the body was last synced with, PhysicsSystem only teleports bodies whose transform changed since
+	unsigned int syncedVersion;
+	//Pose last written to or read from the transform, the transform can be interpolated so it differs from the body
+	vec2 syncedPosition;
+	float syncedRotation;
+	//Body pose before the last fixed step, transforms are interpolated from it to the current pose
+	vec2 previousPosition;
+	float previousAngle;
 	b2Body* body;
 	b2PolygonShape shape;
 	b2FixtureDef fixture;
@@ -28,9 +38,15 @@ struct PhysicsBodyComponent
 		this->isStatic = isStatic;
 		this->isSensor = isSensor;
 		this->useGravity = useGravity;
+		layer = 0;
 
 		this->body = nullptr;
 		globalSize = vec2();
+		syncedVersion = 0;
+		syncedPosition = vec2();
+		syncedRotation = 0;
+		previousPosition = vec2();
+		previousAngle = 0;
 	}
 	PhysicsBodyComponent(ryml::NodeRef node)
 	{
@@ -38,8 +54,14 @@ struct PhysicsBodyComponent
 		this->isStatic = false;
 		this->isSensor = false;
 		this->useGravity = true;
+		layer = 0;
 
 		globalSize = vec2();
+		syncedVersion = 0;
+		syncedPosition = vec2();
+		syncedRotation = 0;
+		previousPosition = vec2();
+		previousAngle = 0;
 		this->body = nullptr;
 
 		ROSE_DESER(PhysicsBodyComponent);
@@ -49,5 +71,5 @@ struct PhysicsBodyComponent
 		ROSE_SER(PhysicsBodyComponent);
 	}
 
-	ROSE_EXPOSE_VARS(PhysicsBodyComponent, (size)(isStatic)(isSensor)(useGravity))
+	ROSE_EXPOSE_VARS(PhysicsBodyComponent, (size)(isStatic)(isSensor)(useGravity)(layer))
 };
\ No newline at end of file
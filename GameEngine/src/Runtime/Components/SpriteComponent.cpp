@@ -0,0 +1,52 @@
+#include "Components/SpriteComponent.h"
+
+#include "Core/Systems.h"
+#include "AssetPipline/AssetStore.h"
+
+SpriteComponent::SpriteComponent(std::string sprite, int layer, vec4 color)
+{
+	this->sprite = sprite;
+	this->spriteId = ROSE_GETSYSTEM(AssetStore).GetAssetId(sprite);
+	this->layer = layer;
+	this->color = color;
+	this->isStatic = false;
+	sourceRectData = DEFAULT_RECT;
+	sourceRect = nullptr;
+	destRect = SDL_FRect();
+}
+
+SpriteComponent::SpriteComponent(ryml::NodeRef node)
+{
+	this->sprite = "";
+	this->color = vec4(1, 1, 1, 1);
+	this->layer = 0;
+	this->isStatic = false;
+	sourceRectData = DEFAULT_RECT;
+	sourceRect = nullptr;
+	destRect = SDL_FRect();
+	if(node.is_map())
+	{
+		if(node.has_child("sprite"))
+		{
+			node["sprite"] >> this->sprite;
+		}
+		if(node.has_child("layer"))
+		{
+			node["layer"] >> this->layer;
+		}
+		if(node.has_child("isStatic"))
+		{
+			node["isStatic"] >> this->isStatic;
+		}
+		if(node.has_child("color"))
+		{
+			auto c = vec4();
+			node["color"][0] >> c.r;
+			node["color"][1] >> c.g;
+			node["color"][2] >> c.b;
+			node["color"][3] >> c.a;
+			this->color = c;
+		}
+	}
+	this->spriteId = ROSE_GETSYSTEM(AssetStore).GetAssetId(this->sprite);
+}
@@ -9,6 +9,7 @@
 #include <glm/glm.hpp>
 
 #include "Reflection/Reflection.h"
+#include "AssetPipline/Asset.h"
 
 using namespace glm;
 
@@ -18,56 +19,26 @@ class SpriteComponent
 {
 public:
 	std::string sprite;
+	//Interned id of sprite, resolved when the name is set
+	AssetId spriteId;
 	glm::vec4 color;
 
 	SDL_Rect sourceRectData;
 	SDL_Rect* sourceRect;
 	SDL_FRect destRect;
 	int layer;
+	//Static sprites are drawn from a prebuilt world space cache and must not move at runtime
+	bool isStatic;
 
-	SpriteComponent(std::string sprite = "block", int layer = 0, vec4 color = vec4(1, 1, 1, 1))
-	{
-		this->sprite = sprite;
-		this->layer = layer;
-		this->color = color;
-		sourceRectData = DEFAULT_RECT;
-		sourceRect = nullptr;
-		destRect = SDL_FRect();
-	}
-	SpriteComponent(ryml::NodeRef node)
-	{
-		this->sprite = "";
-		this->color = vec4(1, 1, 1, 1);
-		this->layer = 0;
-		sourceRectData = DEFAULT_RECT;
-		sourceRect = nullptr;
-		destRect = SDL_FRect();
-		if(node.is_map())
-		{
-			if(node.has_child("sprite"))
-			{
-				node["sprite"] >> this->sprite;
-			}
-			if(node.has_child("layer"))
-			{
-				node["layer"] >> this->layer;
-			}
-			if(node.has_child("color"))
-			{
-				auto c = vec4();
-				node["color"][0] >> c.r;
-				node["color"][1] >> c.g;
-				node["color"][2] >> c.b;
-				node["color"][3] >> c.a;
-				this->color = c;
-			}
-		}
-	}
+	SpriteComponent(std::string sprite = "block", int layer = 0, vec4 color = vec4(1, 1, 1, 1));
+	SpriteComponent(ryml::NodeRef node);
 	SpriteComponent& operator=(const SpriteComponent& other)
 	{
 		this->sprite = other.sprite;
+		this->spriteId = other.spriteId;
 		this->layer = other.layer;
 		this->color = other.color;
+		this->isStatic = other.isStatic;
 		this->sourceRectData = other.sourceRectData;
 		this->destRect = other.destRect;
 		if(other.sourceRect != nullptr)
@@ -82,8 +53,10 @@ public:
 	SpriteComponent(const SpriteComponent& other)
 	{
 		this->sprite = other.sprite;
+		this->spriteId = other.spriteId;
 		this->layer = other.layer;
 		this->color = other.color;
+		this->isStatic = other.isStatic;
 		this->sourceRectData = other.sourceRectData;
 		this->destRect = other.destRect;
 		if(other.sourceRect != nullptr)
@@ -100,11 +73,15 @@ public:
 		node |= ryml::MAP;
 		node["sprite"] << sprite;
 		node["layer"] << layer;
+		if(isStatic)
+		{
+			node["isStatic"] << isStatic;
+		}
 		node["color"] |= ryml::SEQ;
 		node["color"].append_child() << color.x;
 		node["color"].append_child() << color.y;
 		node["color"].append_child() << color.z;
 		node["color"].append_child() << color.w;
 	}
-	ROSE_EXPOSE_VARS(SpriteComponent, (sprite)(layer)(color))
+	ROSE_EXPOSE_VARS(SpriteComponent, (sprite)(layer)(color)(isStatic))
 };
\ No newline at end of file
@@ -2,6 +2,7 @@
 #include "Reflection/Serialize.h"
 
 #include "Core/Systems.h"
+#include "Core/Affine.h"
 
 #include "Core/Log.h"
 
@@ -15,11 +16,13 @@ TransformComponent::TransformComponent(vec2 position, vec2 scale, float rotation
 
 	this->parent = NoEntity();
 	this->scaleSign = vec2(1,1);
-	this->matrixL2W = mat3(0);
+	this->matrixL2W = Affine();
 	globalPosition = vec2();
 	globalScale = vec2();
 	globalRotation = 0;
 	level = 0;
+	dirty = false;
+	version = 0;
 }
 
 TransformComponent::TransformComponent(ryml::NodeRef& node)
@@ -30,11 +33,13 @@ TransformComponent::TransformComponent(ryml::NodeRef& node)
 
 	this->scaleSign = vec2(1, 1);
 	this->parent = NoEntity();
-	this->matrixL2W = mat3(0);
+	this->matrixL2W = Affine();
 	globalPosition = vec2();
 	globalScale = vec2();
 	globalRotation = 0;
 	level = 0;
+	dirty = false;
+	version = 0;
 
 	ROSE_DESER(TransformComponent);
 }
@@ -46,39 +51,23 @@ void TransformComponent::Serialize(ryml::NodeRef node)
 
 void TransformComponent::CalcMatrix()
 {
-	auto matT = mat3(
-		1, 0, position.x,
-		0, 1, position.y,
-		0, 0, 1
-	);
 	rotation = glm::mod(rotation + 360, 360.0f);
-	auto cosT = cos(glm::radians(rotation));
-	auto sinT = sin(glm::radians(rotation));
-	auto matR = mat3(
-		cosT, -sinT, 0,
-		sinT, cosT, 0,
-		0, 0, 1
-	);
-	auto matS = mat3(
-		scale.x, 0, 0,
-		0, scale.y, 0,
-		0, 0, 1
-	);
-	matrixL2W = matS * matR * matT;
+	matrixL2W = Affine::FromTRS(position, scale, rotation);
 	if(parent!=NoEntity())
 	{
 		entt::registry& registry = ROSE_GETSYSTEM(EntitySystem).GetRegistry();
-		auto matrixP2W = registry.get<TransformComponent>(parent).matrixL2W;
-		matrixL2W = matrixL2W * matrixP2W;
+		matrixL2W = matrixL2W * registry.get<TransformComponent>(parent).matrixL2W;
 	}
+	version++;
 }
 
 void TransformComponent::UpdateGlobals()
 {
 	CalcMatrix();
-	globalPosition = GetPosition(matrixL2W);
-	globalScale = GetScale(matrixL2W);
-	globalRotation = GetRotation(matrixL2W);
+	auto matrix = matrixL2W.ToMat3();
+	globalPosition = GetPosition(matrix);
+	globalScale = GetScale(matrix);
+	globalRotation = GetRotation(matrix);
 	globalRotation = glm::mod(globalRotation + 360, 360.0f);
 	scaleSign = vec2(sign(scale.x), sign(scale.y));
 	if(parent!=NoEntity())
@@ -94,7 +83,7 @@ void TransformComponent::UpdateLocals()
 	if(parent!=NoEntity())
 	{
 		auto& pTrx = ROSE_GETSYSTEM(EntitySystem).GetRegistry().get<TransformComponent>(parent);
-		auto matW2P = inverse(pTrx.matrixL2W);
+		auto matW2P = pTrx.matrixL2W.Inverse().ToMat3();
 
 		position = GetPosition(matW2P, globalPosition);
 
@@ -103,7 +92,7 @@ void TransformComponent::UpdateLocals()
 		rotation = GetRotation(matLR);
 		rotation = glm::mod(rotation + 360, 360.0f);
 
-		auto oldGlobalScale = GetScale(matrixL2W);
+		auto oldGlobalScale = GetScale(matrixL2W.ToMat3());
 		auto scaleChange = globalScale / oldGlobalScale;
 		scale = scale * scaleChange;
 	} else
@@ -164,6 +153,27 @@ mat3 TransformComponent::MakeRotMatrix(float angle)
 		0, 0, 1
 	);
 }
+mat3 TransformComponent::MakeLocalMatrix(vec2 position, vec2 scale, float rotation)
+{
+	auto matT = mat3(
+		1, 0, position.x,
+		0, 1, position.y,
+		0, 0, 1
+	);
+	auto cosT = cos(glm::radians(rotation));
+	auto sinT = sin(glm::radians(rotation));
+	auto matR = mat3(
+		cosT, -sinT, 0,
+		sinT, cosT, 0,
+		0, 0, 1
+	);
+	auto matS = mat3(
+		scale.x, 0, 0,
+		0, scale.y, 0,
+		0, 0, 1
+	);
+	return matS * matR * matT;
+}
 mat3 TransformComponent::MakeScaleMatrix(vec2 scale)
 {
 	return mat3(
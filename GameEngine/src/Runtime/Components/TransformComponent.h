@@ -5,6 +5,8 @@
 
 #include "Core/Entity.h"
 
+#include "Core/Affine.h"
+
 #include "Reflection/Reflection.h"
 
 #include "Components/Components.h"
@@ -18,12 +20,17 @@ struct TransformComponent:IComponent
 	float rotation;
 
 	entt::entity parent;
-	mat3 matrixL2W;
+	//Local to world, stored compact so the renderer and TransformSystem use it without conversions
+	Affine matrixL2W;
 	vec2 globalPosition;
 	vec2 globalScale;
 	vec2 scaleSign;
 	int level;
 	float globalRotation;
+	//Set while queued for propagation in TransformSystem::Update
+	bool dirty;
+	//Incremented whenever matrixL2W is recalculated
+	unsigned int version;
 
 	static vec2 GetScale(mat3 matrix);
 	static float GetRotation(mat3 matrix);
@@ -31,6 +38,7 @@ struct TransformComponent:IComponent
 	static vec2 GetPosition(mat3 matrix, vec2 localPos = vec2(0, 0));
 	static vec2 GetDir(mat3 matrix, vec2 localDir);
 	static mat3 MakeRotMatrix(float angle);
+	static mat3 MakeLocalMatrix(vec2 position, vec2 scale, float rotation);
 	mat3 MakeScaleMatrix(vec2 scale);
 
 	TransformComponent(vec2 position = vec2(0, 0), vec2 scale = vec2(1, 1), float rotation = 0);
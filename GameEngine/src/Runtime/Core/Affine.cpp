@@ -0,0 +1,243 @@
+#include "Core/Affine.h"
+
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define ROSE_SSE2
+#endif
+
+Affine::Affine()
+{
+	xx = 1; xy = 0; xw = 0;
+	yx = 0; yy = 1; yw = 0;
+}
+
+Affine::Affine(float xx, float xy, float xw, float yx, float yy, float yw)
+{
+	this->xx = xx; this->xy = xy; this->xw = xw;
+	this->yx = yx; this->yy = yy; this->yw = yw;
+}
+
+Affine::Affine(const glm::mat3& matrix)
+{
+	xx = matrix[0][0]; xy = matrix[0][1]; xw = matrix[0][2];
+	yx = matrix[1][0]; yy = matrix[1][1]; yw = matrix[1][2];
+}
+
+Affine Affine::FromTRS(glm::vec2 position, glm::vec2 scale, float rotation)
+{
+	auto cosT = glm::cos(glm::radians(rotation));
+	auto sinT = glm::sin(glm::radians(rotation));
+	return Affine(
+		cosT * scale.x, -sinT * scale.y, position.x,
+		sinT * scale.x, cosT * scale.y, position.y
+	);
+}
+
+glm::mat3 Affine::ToMat3() const
+{
+	return glm::mat3(
+		xx, xy, xw,
+		yx, yy, yw,
+		0, 0, 1
+	);
+}
+
+Affine Affine::Inverse() const
+{
+	float det = xx * yy - xy * yx;
+	if(det == 0)
+	{
+		return Affine();
+	}
+	float invDet = 1.0f / det;
+	float ixx = yy * invDet;
+	float ixy = -xy * invDet;
+	float iyx = -yx * invDet;
+	float iyy = xx * invDet;
+	return Affine(
+		ixx, ixy, -(ixx * xw + ixy * yw),
+		iyx, iyy, -(iyx * xw + iyy * yw)
+	);
+}
+
+glm::vec2 Affine::Apply(glm::vec2 point) const
+{
+	return {point.x * xx + point.y * xy + xw, point.x * yx + point.y * yy + yw};
+}
+
+glm::vec2 Affine::ApplyDir(glm::vec2 dir) const
+{
+	return {dir.x * xx + dir.y * xy, dir.x * yx + dir.y * yy};
+}
+
+Affine Affine::operator*(const Affine& other) const
+{
+	return Affine(
+		other.xx * xx + other.xy * yx, other.xx * xy + other.xy * yy, other.xx * xw + other.xy * yw + other.xw,
+		other.yx * xx + other.yy * yx, other.yx * xy + other.yy * yy, other.yx * xw + other.yy * yw + other.yw
+	);
+}
+
+#ifdef ROSE_SSE2
+//Four transforms with one component per register
+struct AffineLanes
+{
+	__m128 xx, xy, xw;
+	__m128 yx, yy, yw;
+};
+
+static AffineLanes LoadLanes(const Affine* a)
+{
+	return {
+		_mm_setr_ps(a[0].xx, a[1].xx, a[2].xx, a[3].xx),
+		_mm_setr_ps(a[0].xy, a[1].xy, a[2].xy, a[3].xy),
+		_mm_setr_ps(a[0].xw, a[1].xw, a[2].xw, a[3].xw),
+		_mm_setr_ps(a[0].yx, a[1].yx, a[2].yx, a[3].yx),
+		_mm_setr_ps(a[0].yy, a[1].yy, a[2].yy, a[3].yy),
+		_mm_setr_ps(a[0].yw, a[1].yw, a[2].yw, a[3].yw),
+	};
+}
+
+static AffineLanes BroadcastLanes(const Affine& a)
+{
+	return {
+		_mm_set1_ps(a.xx), _mm_set1_ps(a.xy), _mm_set1_ps(a.xw),
+		_mm_set1_ps(a.yx), _mm_set1_ps(a.yy), _mm_set1_ps(a.yw),
+	};
+}
+
+static void StoreLanes(const AffineLanes& lanes, Affine* out)
+{
+	alignas(16) float values[6][4];
+	_mm_store_ps(values[0], lanes.xx);
+	_mm_store_ps(values[1], lanes.xy);
+	_mm_store_ps(values[2], lanes.xw);
+	_mm_store_ps(values[3], lanes.yx);
+	_mm_store_ps(values[4], lanes.yy);
+	_mm_store_ps(values[5], lanes.yw);
+	for(int i = 0; i < 4; i++)
+	{
+		out[i] = Affine(values[0][i], values[1][i], values[2][i], values[3][i], values[4][i], values[5][i]);
+	}
+}
+
+static __m128 MulAdd(__m128 a, __m128 b, __m128 c, __m128 d)
+{
+	return _mm_add_ps(_mm_mul_ps(a, b), _mm_mul_ps(c, d));
+}
+
+static AffineLanes ComposeLanes(const AffineLanes& l, const AffineLanes& p)
+{
+	return {
+		MulAdd(p.xx, l.xx, p.xy, l.yx),
+		MulAdd(p.xx, l.xy, p.xy, l.yy),
+		_mm_add_ps(MulAdd(p.xx, l.xw, p.xy, l.yw), p.xw),
+		MulAdd(p.yx, l.xx, p.yy, l.yx),
+		MulAdd(p.yx, l.xy, p.yy, l.yy),
+		_mm_add_ps(MulAdd(p.yx, l.xw, p.yy, l.yw), p.yw),
+	};
+}
+#endif
+
+void ComposeAffines(const Affine* locals, const Affine* parents, Affine* out, int count)
+{
+	int i = 0;
+#ifdef ROSE_SSE2
+	for(; i + 4 <= count; i += 4)
+	{
+		StoreLanes(ComposeLanes(LoadLanes(locals + i), LoadLanes(parents + i)), out + i);
+	}
+#endif
+	for(; i < count; i++)
+	{
+		out[i] = locals[i] * parents[i];
+	}
+}
+
+void ComposeAffines(const Affine* locals, const Affine& parent, Affine* out, int count)
+{
+	int i = 0;
+#ifdef ROSE_SSE2
+	auto parentLanes = BroadcastLanes(parent);
+	for(; i + 4 <= count; i += 4)
+	{
+		StoreLanes(ComposeLanes(LoadLanes(locals + i), parentLanes), out + i);
+	}
+#endif
+	for(; i < count; i++)
+	{
+		out[i] = locals[i] * parent;
+	}
+}
+
+void TransformQuads(const Affine* transforms, const glm::vec2* extents, float* out, int count)
+{
+	int i = 0;
+#ifdef ROSE_SSE2
+	for(; i + 4 <= count; i += 4)
+	{
+		auto t = LoadLanes(transforms + i);
+		__m128 ex = _mm_setr_ps(extents[i].x, extents[i + 1].x, extents[i + 2].x, extents[i + 3].x);
+		__m128 ey = _mm_setr_ps(extents[i].y, extents[i + 1].y, extents[i + 2].y, extents[i + 3].y);
+		//Offsets of the +x and +y edges from the center
+		__m128 ax = _mm_mul_ps(ex, t.xx);
+		__m128 ay = _mm_mul_ps(ex, t.yx);
+		__m128 bx = _mm_mul_ps(ey, t.xy);
+		__m128 by = _mm_mul_ps(ey, t.yy);
+		alignas(16) float corners[8][4];
+		_mm_store_ps(corners[0], _mm_add_ps(_mm_sub_ps(bx, ax), t.xw));
+		_mm_store_ps(corners[1], _mm_add_ps(_mm_sub_ps(by, ay), t.yw));
+		_mm_store_ps(corners[2], _mm_add_ps(_mm_add_ps(ax, bx), t.xw));
+		_mm_store_ps(corners[3], _mm_add_ps(_mm_add_ps(ay, by), t.yw));
+		_mm_store_ps(corners[4], _mm_add_ps(_mm_sub_ps(ax, bx), t.xw));
+		_mm_store_ps(corners[5], _mm_add_ps(_mm_sub_ps(ay, by), t.yw));
+		_mm_store_ps(corners[6], _mm_sub_ps(t.xw, _mm_add_ps(ax, bx)));
+		_mm_store_ps(corners[7], _mm_sub_ps(t.yw, _mm_add_ps(ay, by)));
+		for(int q = 0; q < 4; q++)
+		{
+			for(int c = 0; c < 8; c++)
+			{
+				out[(i + q) * 8 + c] = corners[c][q];
+			}
+		}
+	}
+#endif
+	for(; i < count; i++)
+	{
+		const auto& t = transforms[i];
+		auto e = extents[i];
+		auto v1 = t.Apply({-e.x,e.y});
+		auto v2 = t.Apply({e.x,e.y});
+		auto v3 = t.Apply({e.x,-e.y});
+		auto v4 = t.Apply({-e.x,-e.y});
+		float* quad = out + i * 8;
+		quad[0] = v1.x; quad[1] = v1.y;
+		quad[2] = v2.x; quad[3] = v2.y;
+		quad[4] = v3.x; quad[5] = v3.y;
+		quad[6] = v4.x; quad[7] = v4.y;
+	}
+}
+
+void TransformPositions(const Affine& transform, const float* in, float* out, int count)
+{
+	int i = 0;
+#ifdef ROSE_SSE2
+	__m128 xCol = _mm_setr_ps(transform.xx, transform.yx, transform.xx, transform.yx);
+	__m128 yCol = _mm_setr_ps(transform.xy, transform.yy, transform.xy, transform.yy);
+	__m128 offset = _mm_setr_ps(transform.xw, transform.yw, transform.xw, transform.yw);
+	for(; i + 2 <= count; i += 2)
+	{
+		__m128 points = _mm_loadu_ps(in + i * 2);
+		__m128 x = _mm_shuffle_ps(points, points, _MM_SHUFFLE(2, 2, 0, 0));
+		__m128 y = _mm_shuffle_ps(points, points, _MM_SHUFFLE(3, 3, 1, 1));
+		_mm_storeu_ps(out + i * 2, _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, xCol), _mm_mul_ps(y, yCol)), offset));
+	}
+#endif
+	for(; i < count; i++)
+	{
+		float x = in[i * 2];
+		float y = in[i * 2 + 1];
+		out[i * 2] = x * transform.xx + y * transform.xy + transform.xw;
+		out[i * 2 + 1] = x * transform.yx + y * transform.yy + transform.yw;
+	}
+}
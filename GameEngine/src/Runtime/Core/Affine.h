@@ -0,0 +1,34 @@
+#pragma once
+#include <glm/glm.hpp>
+
+//2D affine transform using the engine's row vector convention, x' = x * xx + y * xy + xw and y' = x * yx + y * yy + yw.
+//Matches the top two rows of the glm::mat3 used by TransformComponent
+struct Affine
+{
+	float xx, xy, xw;
+	float yx, yy, yw;
+
+	Affine();
+	Affine(float xx, float xy, float xw, float yx, float yy, float yw);
+	explicit Affine(const glm::mat3& matrix);
+	static Affine FromTRS(glm::vec2 position, glm::vec2 scale, float rotation);
+
+	glm::mat3 ToMat3() const;
+	Affine Inverse() const;
+	glm::vec2 Apply(glm::vec2 point) const;
+	glm::vec2 ApplyDir(glm::vec2 dir) const;
+	//Same order as matrices, a * b applies a first and then b
+	Affine operator*(const Affine& other) const;
+};
+
+//Batch kernels, these use SSE for 4 transforms at a time when available and fall back to scalar code for the rest
+
+//out[i] = locals[i] * parents[i]
+void ComposeAffines(const Affine* locals, const Affine* parents, Affine* out, int count);
+//out[i] = locals[i] * parent
+void ComposeAffines(const Affine* locals, const Affine& parent, Affine* out, int count);
+//Writes the corners of quads centered on each transform as 8 interleaved xy floats per quad,
+//in the order (-x,+y), (+x,+y), (+x,-y), (-x,-y)
+void TransformQuads(const Affine* transforms, const glm::vec2* extents, float* out, int count);
+//Applies one transform to interleaved xy positions
+void TransformPositions(const Affine& transform, const float* in, float* out, int count);
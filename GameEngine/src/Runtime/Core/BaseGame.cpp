@@ -8,8 +8,10 @@
 #include "Core/SdlContainer.h"
 #include "AssetPipline/AssetStore.h"
 #include "Core/Entity.h"
+#include "Core/JobSystem.h"
 #include "Project/ProjectLoader.h"
 #include "Levels/LevelLoader.h"
+#include "Levels/PrefabSystem.h"
 
 #include "Core/Transform.h"
 #include "Physics/Physics.h"
@@ -25,9 +27,9 @@
 
 #include "Gameplay/CombatSystem.h"
 
-BaseGame::BaseGame()
+BaseGame::BaseGame(bool headless)
 {
-	SetupBaseSystems();
+	SetupBaseSystems(headless);
 	SetupLowLevelSystems();
 	ROSE_LOG("Game constructed");
 }
@@ -35,6 +37,7 @@ BaseGame::BaseGame()
 BaseGame::~BaseGame()
 {
 	ROSE_DESTROYSYSTEM(CombatSystem);
+	ROSE_DESTROYSYSTEM(PrefabSystem);
 
 	ROSE_DESTROYSYSTEM(PhysicsSystem);
 	ROSE_DESTROYSYSTEM(TransformSystem);
@@ -52,6 +55,7 @@ BaseGame::~BaseGame()
 	ROSE_DESTROYSYSTEM(AssetStore);
 	ROSE_DESTROYSYSTEM(LevelLoader);
 	ROSE_DESTROYSYSTEM(EntitySystem);
+	ROSE_DESTROYSYSTEM(JobSystem);
 	ROSE_DESTROYSYSTEM(ReflectionSystem);
 	ROSE_DESTROYSYSTEM(FileDialog);
 	ROSE_DESTROYSYSTEM(SdlContainer);
@@ -59,11 +63,12 @@ BaseGame::~BaseGame()
 	ROSE_LOG("Game destrcuted");
 }
 
-void BaseGame::SetupBaseSystems()
+void BaseGame::SetupBaseSystems(bool headless)
 {
-	ROSE_CREATESYSTEM(SdlContainer, 1200, (float)1200 * 9 / 16);
+	ROSE_CREATESYSTEM(SdlContainer, 1200, (float)1200 * 9 / 16, "Rose Engine", headless);
 	ROSE_CREATESYSTEM(FileDialog);
 	ROSE_CREATESYSTEM(ReflectionSystem);
+	ROSE_CREATESYSTEM(JobSystem);
 	ROSE_CREATESYSTEM(EntitySystem);
 	ROSE_CREATESYSTEM(LevelLoader);
 	ROSE_CREATESYSTEM(AssetStore);
@@ -83,6 +88,7 @@ void BaseGame::SetupLowLevelSystems()
 	ROSE_CREATESYSTEM(ScriptSystem);
 	ROSE_CREATESYSTEM(TransformSystem);
 	ROSE_CREATESYSTEM(PhysicsSystem, 0, -10);
+	ROSE_CREATESYSTEM(PrefabSystem);
 
 	ROSE_CREATESYSTEM(CombatSystem);
 }
@@ -6,12 +6,12 @@
 class BaseGame: public IApplication
 {
 protected:
-	void SetupBaseSystems();
+	void SetupBaseSystems(bool headless);
 	void SetupLowLevelSystems();
 	void LoadProject(const std::string& projectName);
 	void Setup();
 
 public:
-	BaseGame();
+	BaseGame(bool headless = false);
 	~BaseGame();
 };
@@ -37,12 +37,17 @@ void DisableSystem::Disable(entt::entity entity)
 }
 void DisableSystem::DisableCreated(entt::registry& registry, entt::entity entity)
 {
-	DisableChildren(entity);
+	PropagateToChildren(entity, true);
 }
 
 void DisableSystem::DisableDestroyed(entt::registry& registry, entt::entity entity)
 {
-	EnableChildren(entity);
+	//Children of a destroyed entity are destroyed before it, there is nothing to enable
+	if(ROSE_GETSYSTEM(EntitySystem).IsDestroying())
+	{
+		return;
+	}
+	PropagateToChildren(entity, false);
 }
 
 void DisableSystem::ParentUpdated(entt::registry& registry, entt::entity entity)
@@ -70,38 +75,49 @@ void DisableSystem::EnableChild(entt::entity entity)
 	Enable(entity);
 }
 
-void DisableSystem::DisableChildren(entt::entity entity)
-{
-	entt::registry& registry = ROSE_GETSYSTEM(EntitySystem).GetRegistry();
-	auto& levelTree = ROSE_GETSYSTEM(LevelTree);
-	if(levelTree.GetNode(entity) != nullptr)
-	{
-		for(const auto& child : levelTree.GetNode(entity)->children)
-		{
-			auto& childDisable = registry.get_or_emplace<DisableComponent>(child->element, false, true);
-			childDisable.parentDisabled = true;
-		}
-	}
-}
 void DisableSystem::DisableChild(entt::entity child)
 {
 	entt::registry& registry = ROSE_GETSYSTEM(EntitySystem).GetRegistry();
 	auto& childDisable = registry.get_or_emplace<DisableComponent>(child, false, true);
 	childDisable.parentDisabled = true;
 }
-void DisableSystem::EnableChildren(entt::entity entity)
+void DisableSystem::PropagateToChildren(entt::entity entity, bool disabled)
 {
+	if(propagating)
+	{
+		return;
+	}
+	propagating = true;
 	entt::registry& registry = ROSE_GETSYSTEM(EntitySystem).GetRegistry();
 	auto& levelTree = ROSE_GETSYSTEM(LevelTree);
-	if(levelTree.GetNode(entity) != nullptr)
+	walk.clear();
+	walk.push_back(entity);
+	for(int i = 0; i < walk.size(); i++)
 	{
-		for(auto child : levelTree.GetNode(entity)->children)
+		for(auto child = levelTree.GetFirstChild(walk[i]); child != NoEntity(); child = levelTree.GetNextSibling(child))
 		{
-			auto& childDisable = registry.get<DisableComponent>(child->element);
-			if(!childDisable.selfDisabled)
+			auto childDisable = registry.try_get<DisableComponent>(child);
+			if(disabled)
+			{
+				//A child that was already disabled has its subtree disabled too
+				if(childDisable == nullptr)
+				{
+					registry.emplace<DisableComponent>(child, false, true);
+					walk.push_back(child);
+				} else
+				{
+					childDisable->parentDisabled = true;
+				}
+			} else if(childDisable != nullptr)
 			{
-				registry.remove<DisableComponent>(child->element);
+				childDisable->parentDisabled = false;
+				if(!childDisable->selfDisabled)
+				{
+					registry.remove<DisableComponent>(child);
+					walk.push_back(child);
+				}
 			}
 		}
 	}
-}
\ No newline at end of file
+	propagating = false;
+}
@@ -1,4 +1,6 @@
 #pragma once
+#include <vector>
+
 #include <entt/entity/entity.hpp>
 #include <entt/entity/registry.hpp>
 
@@ -8,9 +10,13 @@ class DisableSystem
 	void DisableDestroyed(entt::registry& registry, entt::entity);
 	void ParentUpdated(entt::registry& registry, entt::entity);
 	void EnableChild(entt::entity entity);
-	void DisableChildren(entt::entity entity);
 	void DisableChild(entt::entity entity);
-	void EnableChildren(entt::entity entity);
+	//Sets or clears parentDisabled below entity in one walk of the subtree, hooks fired by the walk itself are ignored
+	void PropagateToChildren(entt::entity entity, bool disabled);
+
+	bool propagating = false;
+	//Scratch list of the subtree walk
+	std::vector<entt::entity> walk;
 public:
 	DisableSystem();
 	void Enable(entt::entity entity);
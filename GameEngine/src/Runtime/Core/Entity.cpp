@@ -8,11 +8,12 @@
 #include "DisableSystem.h"
 
 #include "Components/GUIDComponent.h"
+#include "Components/DisableComponent.h"
 
 EntitySystem::EntitySystem()
 {
 	mainRegistry = entt::registry();
-	ROSE_CREATESYSTEM(LevelTree);
+	ROSE_CREATESYSTEM(LevelTree, mainRegistry);
 }
 
 entt::registry& EntitySystem::GetRegistry()
@@ -56,6 +57,7 @@ bool EntitySystem::EntityExists(entt::entity entity)
 void EntitySystem::DestroyAllEntities()
 {
 	auto& registry = GetRegistry();
+	destroying = true;
 	for(auto& it : allEntities)
 	{
 		if(registry.valid(it.second))
@@ -63,6 +65,7 @@ void EntitySystem::DestroyAllEntities()
 			registry.destroy(it.second);
 		}
 	}
+	destroying = false;
 	allEntities.clear();
 	allEntityGuids.clear();
 	ROSE_GETSYSTEM(LevelTree).Clear();
@@ -78,6 +81,55 @@ entt::entity EntitySystem::CreateEntity()
 	ROSE_GETSYSTEM(LevelTree).AddEntity(entity);
 	return entity;
 }
+std::vector<entt::entity> EntitySystem::CreateEntities(int count, entt::entity parent)
+{
+	auto& registry = GetRegistry();
+	std::vector<entt::entity> entities(count);
+	if(count <= 0)
+	{
+		return entities;
+	}
+	registry.create(entities.begin(), entities.end());
+	AddEntities(entities.data(), count, parent);
+	return entities;
+}
+void EntitySystem::AddEntities(const entt::entity* entities, int count, entt::entity parent)
+{
+	auto& registry = GetRegistry();
+	if(count <= 0)
+	{
+		return;
+	}
+	std::vector<Guid> guids(count);
+	GuidGenerator::New(guids.data(), count);
+	GUIDComponent guidComp(Guid(-1));
+	guidComp.name = "";
+	if(EntityExists(parent))
+	{
+		guidComp.parent = parent;
+		guidComp.parentId = GetEntityGuid(parent);
+	} else
+	{
+		parent = NoEntity();
+	}
+	std::vector<GUIDComponent> guidComps(count, guidComp);
+	allEntities.reserve(allEntities.size() + count);
+	allEntityGuids.reserve(allEntityGuids.size() + count);
+	for(int i = 0; i < count; i++)
+	{
+		guidComps[i].id = guids[i];
+		allEntities.emplace(guids[i], entities[i]);
+		allEntityGuids.emplace(entities[i], guids[i]);
+	}
+	registry.insert<GUIDComponent>(entities, entities + count, guidComps.begin());
+	ROSE_GETSYSTEM(LevelTree).AddEntities(entities, count, parent);
+
+	//Parents are set directly instead of patching each GUIDComponent, so inherited disabling is applied here
+	if(parent != NoEntity() && registry.any_of<DisableComponent>(parent))
+	{
+		registry.insert<DisableComponent>(entities, entities + count, DisableComponent(false, true));
+	}
+}
 entt::entity EntitySystem::DeserializeEntity(ryml::NodeRef& node)
 {
 	auto& registry = GetRegistry();
@@ -118,6 +170,7 @@ entt::entity EntitySystem::CopyEntity(entt::entity src, entt::entity parent)
 	auto& guidComp = registry.get<GUIDComponent>(entity);
 	auto& srcGuidComp = registry.get<GUIDComponent>(src);
 	guidComp.name = srcGuidComp.name;
+	registry.patch<GUIDComponent>(entity);
 	if(parent != NoEntity())
 	{
 		ROSE_GETSYSTEM(LevelTree).TrySetParent(entity, parent);
@@ -129,9 +182,10 @@ entt::entity EntitySystem::CopyEntity(entt::entity src, entt::entity parent)
 			storage.emplace(entity, storage.get(src));
 		}
 	}
-	for(auto child : ROSE_GETSYSTEM(LevelTree).GetNode(src)->children)
+	auto& levelTree = ROSE_GETSYSTEM(LevelTree);
+	for(auto child = levelTree.GetFirstChild(src); child != NoEntity(); child = levelTree.GetNextSibling(child))
 	{
-		auto childEntity = CopyEntity(child->element, entity);
+		auto childEntity = CopyEntity(child, entity);
 	}
 	return entity;
 }
@@ -148,18 +202,68 @@ void EntitySystem::DisableEntity(entt::entity entity)
 
 
 void EntitySystem::DestroyEntity(entt::entity entity)
+{
+	DestroyEntities({entity});
+}
+
+void EntitySystem::DestroyEntities(const std::vector<entt::entity>& roots)
 {
 	auto& registry = GetRegistry();
-	if(EntityExists(entity))
+	auto& levelTree = ROSE_GETSYSTEM(LevelTree);
+	//Parents come before their children, walking it backwards removes leaves first so nothing gets moved to the root
+	destroyOrder.clear();
+	//Roots under another root, or given twice, are already part of a subtree being destroyed
+	destroyRoots.clear();
+	destroyRoots.insert(roots.begin(), roots.end());
+	collectedRoots.clear();
+	for(auto root : roots)
 	{
-		for(auto child : ROSE_GETSYSTEM(LevelTree).GetNode(entity)->children)
+		if(!EntityExists(root) || !collectedRoots.insert(root).second)
+		{
+			continue;
+		}
+		bool covered = false;
+		for(auto parent = levelTree.GetParent(root); parent != NoEntity() && !covered; parent = levelTree.GetParent(parent))
+		{
+			covered = destroyRoots.count(parent) != 0;
+		}
+		if(covered)
+		{
+			continue;
+		}
+		int first = destroyOrder.size();
+		destroyOrder.push_back(root);
+		for(int i = first; i < destroyOrder.size(); i++)
 		{
-			DestroyEntity(child->element);
+			for(auto child = levelTree.GetFirstChild(destroyOrder[i]); child != NoEntity(); child = levelTree.GetNextSibling(child))
+			{
+				destroyOrder.push_back(child);
+			}
 		}
-		ROSE_GETSYSTEM(LevelTree).RemoveEntity(entity);
-		auto guid = allEntityGuids[entity];
+	}
+	for(auto it = destroyOrder.rbegin(); it != destroyOrder.rend(); it++)
+	{
+		levelTree.RemoveEntity(*it);
+		auto guid = allEntityGuids[*it];
 		allEntities.erase(guid);
-		allEntityGuids.erase(entity);
-		registry.destroy(entity);
+		allEntityGuids.erase(*it);
 	}
+	destroying = true;
+	registry.destroy(destroyOrder.rbegin(), destroyOrder.rend());
+	destroying = false;
+}
+
+bool EntitySystem::IsDestroying() const
+{
+	return destroying;
+}
+
+EntityCommandBuffer& EntitySystem::GetCommands()
+{
+	return commands;
+}
+
+void EntitySystem::FlushCommands()
+{
+	commands.Play(GetRegistry());
 }
@@ -1,6 +1,8 @@
 #pragma once
 #include <unordered_map>
+#include <unordered_set>
 #include "Core/Guid.h"
+#include "Core/EntityCommands.h"
 
 #include <entt/entity/entity.hpp>
 #include <entt/entity/registry.hpp>
@@ -20,10 +22,19 @@ private:
 	EntityMap allEntities;
 	GuidMap allEntityGuids;
 	entt::registry mainRegistry;
+	EntityCommandBuffer commands;
+	std::vector<entt::entity> destroyOrder;
+	std::unordered_set<entt::entity> destroyRoots;
+	std::unordered_set<entt::entity> collectedRoots;
+	bool destroying = false;
 
 public:
 	EntitySystem();
 	entt::entity CreateEntity();
+	//Creates count empty entities under parent with their storage, GUIDs and tree nodes allocated in bulk
+	std::vector<entt::entity> CreateEntities(int count, entt::entity parent = NoEntity());
+	//Registers entities made with registry.create() the way CreateEntities does, for handles reserved before their setup
+	void AddEntities(const entt::entity* entities, int count, entt::entity parent = NoEntity());
 	entt::entity DeserializeEntity(ryml::NodeRef& node);
 	entt::registry& GetRegistry();
 	entt::entity GetEntity(Guid guid);
@@ -32,6 +43,13 @@ public:
 	bool EntityExists(entt::entity);
 	void DestroyAllEntities();
 	void DestroyEntity(entt::entity entity);
+	//Destroys each entity with its subtree, children are destroyed before their parents
+	void DestroyEntities(const std::vector<entt::entity>& roots);
+	//True while entities are being destroyed, component destroy hooks use it to tell removal from destruction
+	bool IsDestroying() const;
+	//Commands are played back by FlushCommands, the game and editor call it once per frame after scripts and events
+	EntityCommandBuffer& GetCommands();
+	void FlushCommands();
 	void EnableEntity(entt::entity entity);
 	void DisableEntity(entt::entity entity);
 	entt::entity CopyEntity(entt::entity entity, entt::entity parent = NoEntity());
@@ -0,0 +1,252 @@
+#include "Core/EntityCommands.h"
+
+#include <algorithm>
+
+#include "Core/Entity.h"
+#include "Core/LevelTree.h"
+#include "Core/DisableSystem.h"
+#include "Core/Systems.h"
+#include "Levels/PrefabSystem.h"
+
+const unsigned char DESTROY_MARK = 1;
+const unsigned char RELEASE_MARK = 2;
+
+void EntityCommandBuffer::Create(std::function<void(entt::entity)> setup)
+{
+	recorded.creates.push_back(std::move(setup));
+}
+
+void EntityCommandBuffer::Spawn(std::function<void()> spawn)
+{
+	recorded.spawns.push_back(std::move(spawn));
+}
+
+void EntityCommandBuffer::Destroy(entt::entity entity)
+{
+	if(entity == NoEntity() || IsDestroyQueued(entity))
+	{
+		return;
+	}
+	Mark(entity, DESTROY_MARK);
+	recorded.destroys.push_back(entity);
+}
+
+void EntityCommandBuffer::Release(entt::entity root)
+{
+	if(root == NoEntity() || IsDestroyQueued(root))
+	{
+		return;
+	}
+	Mark(root, RELEASE_MARK);
+	recorded.releases.push_back(root);
+}
+
+void EntityCommandBuffer::Mark(entt::entity entity, unsigned char mark)
+{
+	auto index = entt::to_entity(entity);
+	if(index >= destroyMarks.size())
+	{
+		destroyMarks.resize(index + 1, 0);
+	}
+	destroyMarks[index] = mark;
+}
+
+void EntityCommandBuffer::Enable(entt::entity entity)
+{
+	recorded.enables.push_back({entity, true});
+}
+
+void EntityCommandBuffer::Disable(entt::entity entity)
+{
+	recorded.enables.push_back({entity, false});
+}
+
+void EntityCommandBuffer::SetParent(entt::entity child, entt::entity parent)
+{
+	recorded.parents.push_back({child, parent});
+}
+
+bool EntityCommandBuffer::IsDestroyQueued(entt::entity entity) const
+{
+	auto index = entt::to_entity(entity);
+	return index < destroyMarks.size() && destroyMarks[index] != 0;
+}
+
+bool EntityCommandBuffer::IsEmpty() const
+{
+	return recorded.IsEmpty();
+}
+
+void EntityCommandBuffer::Play(entt::registry& registry)
+{
+	while(!recorded.IsEmpty())
+	{
+		std::swap(recorded, playing);
+		PlayPass(registry);
+		ClearMarks(playing.destroys);
+		ClearMarks(playing.releases);
+		playing.Clear();
+	}
+}
+
+void EntityCommandBuffer::PlayPass(entt::registry& registry)
+{
+	auto& entities = ROSE_GETSYSTEM(EntitySystem);
+	auto& levelTree = ROSE_GETSYSTEM(LevelTree);
+	for(auto& setup : playing.creates)
+	{
+		auto entity = entities.CreateEntity();
+		if(setup)
+		{
+			setup(entity);
+		}
+	}
+	for(auto& spawn : playing.spawns)
+	{
+		spawn();
+	}
+	for(auto& add : playing.adds)
+	{
+		add(registry);
+	}
+	for(auto& command : playing.parents)
+	{
+		if(!registry.valid(command.child) || IsDestroyQueued(command.child))
+		{
+			continue;
+		}
+		if(command.parent == NoEntity())
+		{
+			levelTree.RemoveParent(command.child);
+		} else if(registry.valid(command.parent))
+		{
+			levelTree.TrySetParent(command.child, command.parent);
+		}
+	}
+	PlayRemoves(registry);
+	auto& disableSystem = ROSE_GETSYSTEM(DisableSystem);
+	for(auto& command : playing.enables)
+	{
+		if(!registry.valid(command.entity) || IsDestroyQueued(command.entity))
+		{
+			continue;
+		}
+		if(command.enable)
+		{
+			disableSystem.Enable(command.entity);
+		} else
+		{
+			disableSystem.Disable(command.entity);
+		}
+	}
+	PlayReleases(registry);
+	PlayDestroys(registry);
+}
+
+void EntityCommandBuffer::PlayRemoves(entt::registry& registry)
+{
+	//Sorted so each storage is visited once and its entities are removed as one range
+	auto& removes = playing.removes;
+	std::sort(removes.begin(), removes.end(), [](const RemoveCommand& a, const RemoveCommand& b)
+		{
+			if(a.storage != b.storage)
+			{
+				return a.storage < b.storage;
+			}
+			return a.entity < b.entity;
+		});
+	for(int runStart = 0; runStart < removes.size();)
+	{
+		auto id = removes[runStart].storage;
+		removeRun.clear();
+		int i = runStart;
+		for(; i < removes.size() && removes[i].storage == id; i++)
+		{
+			if(removeRun.empty() || removeRun.back() != removes[i].entity)
+			{
+				removeRun.push_back(removes[i].entity);
+			}
+		}
+		runStart = i;
+		auto storage = registry.storage(id);
+		if(storage != nullptr)
+		{
+			storage->remove(removeRun.begin(), removeRun.end());
+		}
+	}
+}
+
+void EntityCommandBuffer::PlayReleases(entt::registry& registry)
+{
+	auto& prefabs = ROSE_GETSYSTEM(PrefabSystem);
+	//Instances the pool does not take are destroyed in the same pass
+	for(auto root : playing.releases)
+	{
+		if(registry.valid(root) && !prefabs.Release(root))
+		{
+			Mark(root, DESTROY_MARK);
+			playing.destroys.push_back(root);
+		}
+	}
+}
+
+void EntityCommandBuffer::PlayDestroys(entt::registry& registry)
+{
+	//Entities under another queued entity are destroyed with its subtree
+	auto& levelTree = ROSE_GETSYSTEM(LevelTree);
+	destroyRoots.clear();
+	for(auto entity : playing.destroys)
+	{
+		if(!registry.valid(entity))
+		{
+			continue;
+		}
+		bool covered = false;
+		for(auto parent = levelTree.GetParent(entity); parent != NoEntity(); parent = levelTree.GetParent(parent))
+		{
+			auto index = entt::to_entity(parent);
+			if(index < destroyMarks.size() && destroyMarks[index] == DESTROY_MARK)
+			{
+				covered = true;
+				break;
+			}
+		}
+		if(!covered)
+		{
+			destroyRoots.push_back(entity);
+		}
+	}
+	ROSE_GETSYSTEM(EntitySystem).DestroyEntities(destroyRoots);
+}
+
+void EntityCommandBuffer::ClearMarks(const std::vector<entt::entity>& entities)
+{
+	for(auto entity : entities)
+	{
+		destroyMarks[entt::to_entity(entity)] = 0;
+	}
+}
+
+void EntityCommandBuffer::Clear()
+{
+	ClearMarks(recorded.destroys);
+	ClearMarks(recorded.releases);
+	recorded.Clear();
+}
+
+bool EntityCommandBuffer::CommandLists::IsEmpty() const
+{
+	return creates.empty() && spawns.empty() && adds.empty() && parents.empty() && removes.empty() && enables.empty() && releases.empty() && destroys.empty();
+}
+
+void EntityCommandBuffer::CommandLists::Clear()
+{
+	creates.clear();
+	spawns.clear();
+	adds.clear();
+	parents.clear();
+	removes.clear();
+	enables.clear();
+	destroys.clear();
+	releases.clear();
+}
@@ -0,0 +1,96 @@
+#pragma once
+#include <vector>
+#include <functional>
+
+#include <entt/entity/entity.hpp>
+#include <entt/entity/registry.hpp>
+#include <entt/core/type_info.hpp>
+
+//Structural changes recorded during the frame and played back together at a sync point
+//Playback order is creates, spawns, component adds, reparents, component removals, enable/disable, releases and destroys last
+class EntityCommandBuffer
+{
+	struct ParentCommand
+	{
+		entt::entity child;
+		entt::entity parent;
+	};
+	struct EnableCommand
+	{
+		entt::entity entity;
+		bool enable;
+	};
+	struct RemoveCommand
+	{
+		entt::id_type storage;
+		entt::entity entity;
+	};
+
+	struct CommandLists
+	{
+		std::vector<std::function<void(entt::entity)>> creates;
+		std::vector<std::function<void()>> spawns;
+		std::vector<std::function<void(entt::registry&)>> adds;
+		std::vector<ParentCommand> parents;
+		std::vector<RemoveCommand> removes;
+		std::vector<EnableCommand> enables;
+		std::vector<entt::entity> destroys;
+		std::vector<entt::entity> releases;
+
+		bool IsEmpty() const;
+		void Clear();
+	};
+
+	//Commands are recorded into recorded and swapped into playing for each pass, so hooks and callbacks that run
+	//during playback record into the next pass instead of the lists being walked
+	CommandLists recorded;
+	CommandLists playing;
+	//Indexed by entt::to_entity, set for entities in destroys or releases of either list
+	std::vector<unsigned char> destroyMarks;
+
+	//Scratch buffers reused between playbacks
+	std::vector<entt::entity> removeRun;
+	std::vector<entt::entity> destroyRoots;
+
+	void Mark(entt::entity entity, unsigned char mark);
+	void PlayPass(entt::registry& registry);
+	void PlayRemoves(entt::registry& registry);
+	void PlayReleases(entt::registry& registry);
+	void PlayDestroys(entt::registry& registry);
+	void ClearMarks(const std::vector<entt::entity>& entities);
+
+public:
+	//setup runs on the new entity during playback, after it has its GUIDComponent and a place in the level tree
+	void Create(std::function<void(entt::entity)> setup = nullptr);
+	//spawn runs during playback after the creates, for systems that create and set up entities in bulk
+	void Spawn(std::function<void()> spawn);
+	void Destroy(entt::entity entity);
+	//Returns a pooled prefab instance to its pool, it is destroyed instead when the pool can not take it
+	void Release(entt::entity root);
+	void Enable(entt::entity entity);
+	void Disable(entt::entity entity);
+	void SetParent(entt::entity child, entt::entity parent);
+	//Also true for released entities, scripts skip both for the rest of the frame
+	bool IsDestroyQueued(entt::entity entity) const;
+	bool IsEmpty() const;
+	//Plays passes until no commands are left, commands recorded during playback run in a later pass
+	void Play(entt::registry& registry);
+	void Clear();
+
+	template<typename TComponent>
+	void AddComponent(entt::entity entity, TComponent component)
+	{
+		recorded.adds.push_back([entity, component = std::move(component)](entt::registry& registry) mutable
+			{
+				if(registry.valid(entity))
+				{
+					registry.emplace_or_replace<TComponent>(entity, std::move(component));
+				}
+			});
+	}
+	template<typename TComponent>
+	void RemoveComponent(entt::entity entity)
+	{
+		recorded.removes.push_back({entt::type_hash<TComponent>::value(), entity});
+	}
+};
@@ -1,8 +1,12 @@
 #include "Game.h"
 #include "BaseGame.h"
 
+#include <algorithm>
+#include <numeric>
+
 #include "Core/SdlContainer.h"
 #include "Core/Systems.h"
+#include "Core/FileResource.h"
 
 #include "Core/Transform.h"
 #include "Physics/Physics.h"
@@ -14,9 +18,17 @@
 #include "Events/EntityEventSystem.h"
 #include "Scripting/ScriptSystem.h"
 
-Game::Game():BaseGame()
+const int HEADLESS_DEFAULT_FRAMES = 600;
+
+Game::Game(const GameOptions& options):BaseGame(options.headless)
 {
 	isRunning = false;
+	this->options = options;
+	if(this->options.headless && this->options.frameCount <= 0)
+	{
+		this->options.frameCount = HEADLESS_DEFAULT_FRAMES;
+	}
+	frame = 0;
 }
 
 Game::~Game()
@@ -26,12 +38,24 @@ Game::~Game()
 void Game::Run()
 {
 	Setup();
+	RendererSystem& renderer = ROSE_GETSYSTEM(RendererSystem);
+	if(options.pipelinedRendering && options.frameDumpPath.empty())
+	{
+		renderer.SetPipelinedRendering(true);
+	}
 	isRunning = true;
 	while(isRunning)
 	{
 		Update();
 		Render();
+		frame++;
+		if(options.frameCount > 0 && frame >= options.frameCount)
+		{
+			isRunning = false;
+		}
 	}
+	renderer.SetPipelinedRendering(false);
+	ReportRenderTimes();
 }
 
 void Game::Update()
@@ -49,11 +73,58 @@ void Game::Update()
 	ROSE_GETSYSTEM(AnimationSystem).Update();
 	ROSE_GETSYSTEM(EntityEventSystem).Update();
 	ROSE_GETSYSTEM(ScriptSystem).Update();
+	ROSE_GETSYSTEM(EntitySystem).FlushCommands();
 }
 
 void Game::Render()
 {
 	RendererSystem& renderer = ROSE_GETSYSTEM(RendererSystem);
+	auto start = SDL_GetPerformanceCounter();
 	renderer.Render();
+	auto end = SDL_GetPerformanceCounter();
+	//The back buffer is undefined after present, so frames are read before it
+	if(!options.frameDumpPath.empty())
+	{
+		char fileName[32];
+		SDL_snprintf(fileName, sizeof(fileName), "/frame_%05d.png", frame);
+		if(!ROSE_GETSYSTEM(SdlContainer).SaveFrame(options.frameDumpPath + fileName))
+		{
+			SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't save frame %d: %s", frame, SDL_GetError());
+		}
+		start += SDL_GetPerformanceCounter() - end;
+	}
 	renderer.Present();
+	if(options.headless || !options.timingsPath.empty())
+	{
+		renderTimes.push_back((SDL_GetPerformanceCounter() - start) * 1000.0 / SDL_GetPerformanceFrequency());
+	}
+}
+
+void Game::ReportRenderTimes()
+{
+	if(renderTimes.empty())
+	{
+		return;
+	}
+	if(!options.timingsPath.empty())
+	{
+		auto fileHandle = FileResource(options.timingsPath, "w+");
+		if(fileHandle.file != nullptr)
+		{
+			std::string csv = "frame,renderMs\n";
+			for(int i = 0; i < renderTimes.size(); i++)
+			{
+				csv += std::to_string(i) + "," + std::to_string(renderTimes[i]) + "\n";
+			}
+			SDL_RWwrite(fileHandle.file, csv.data(), 1, csv.size());
+		} else
+		{
+			SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't write render timings to %s", options.timingsPath.c_str());
+		}
+	}
+	auto sorted = renderTimes;
+	std::sort(sorted.begin(), sorted.end());
+	double average = std::accumulate(sorted.begin(), sorted.end(), 0.0) / sorted.size();
+	SDL_Log("Rendered %d frames: avg %.3fms min %.3fms median %.3fms p99 %.3fms max %.3fms", (int)sorted.size(), average,
+		sorted.front(), sorted[sorted.size() / 2], sorted[(sorted.size() * 99) / 100], sorted.back());
 }
\ No newline at end of file
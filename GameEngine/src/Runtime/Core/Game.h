@@ -1,15 +1,36 @@
 #pragma once
+#include <string>
+#include <vector>
+
 #include "BaseGame.h"
 
+struct GameOptions
+{
+	//Renders offscreen through the software renderer without a window
+	bool headless = false;
+	//Stops after this many frames, zero runs until the window is closed
+	int frameCount = 0;
+	//Folder to write every frame to as a png, empty disables dumping
+	std::string frameDumpPath = "";
+	//File to write per frame render timings to as csv, empty disables it
+	std::string timingsPath = "";
+	//Builds each frame's vertices on a worker thread while the previous frame is submitted, ignored when dumping frames
+	bool pipelinedRendering = false;
+};
+
 class Game: public BaseGame
 {
 private:
 	bool isRunning;
+	GameOptions options;
+	int frame;
+	std::vector<double> renderTimes;
 	void Update();
 	void Render();
+	void ReportRenderTimes();
 
 public:
-	Game();
+	Game(const GameOptions& options = GameOptions());
 	~Game();
 	virtual void Run() override;
 };
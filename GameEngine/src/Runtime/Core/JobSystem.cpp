@@ -0,0 +1,113 @@
+#include "Core/JobSystem.h"
+
+#include <algorithm>
+
+#include "Core/Log.h"
+
+JobSystem::JobSystem(int threadCount)
+{
+	job = nullptr;
+	jobSize = 0;
+	chunkSize = 1;
+	nextChunk = 0;
+	busyWorkers = 0;
+	jobId = 0;
+	stopping = false;
+	if(threadCount < 0)
+	{
+		threadCount = std::max((int)std::thread::hardware_concurrency() - 1, 0);
+	}
+	for(int i = 0; i < threadCount; i++)
+	{
+		workers.emplace_back(&JobSystem::WorkerLoop, this);
+	}
+	ROSE_LOG("Job system started with %d worker threads", threadCount);
+}
+
+JobSystem::~JobSystem()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	jobReady.notify_all();
+	for(auto& worker : workers)
+	{
+		worker.join();
+	}
+}
+
+int JobSystem::GetThreadCount() const
+{
+	return workers.size() + 1;
+}
+
+void JobSystem::RunChunks()
+{
+	while(true)
+	{
+		int begin = nextChunk.fetch_add(chunkSize);
+		if(begin >= jobSize)
+		{
+			return;
+		}
+		(*job)(begin, std::min(begin + chunkSize, jobSize));
+	}
+}
+
+void JobSystem::WorkerLoop()
+{
+	unsigned int lastJob = 0;
+	while(true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			jobReady.wait(lock, [this, lastJob]()
+				{
+					return stopping || jobId != lastJob;
+				});
+			if(stopping)
+			{
+				return;
+			}
+			lastJob = jobId;
+		}
+		RunChunks();
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			busyWorkers--;
+		}
+		jobDone.notify_one();
+	}
+}
+
+void JobSystem::ParallelFor(int count, int chunkSize, const std::function<void(int, int)>& job)
+{
+	if(count <= 0)
+	{
+		return;
+	}
+	chunkSize = std::max(chunkSize, 1);
+	if(workers.empty() || count <= chunkSize)
+	{
+		job(0, count);
+		return;
+	}
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		this->job = &job;
+		this->jobSize = count;
+		this->chunkSize = chunkSize;
+		nextChunk = 0;
+		busyWorkers = workers.size();
+		jobId++;
+	}
+	jobReady.notify_all();
+	RunChunks();
+	std::unique_lock<std::mutex> lock(mutex);
+	jobDone.wait(lock, [this]()
+		{
+			return busyWorkers == 0;
+		});
+	this->job = nullptr;
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+
+//Fixed pool of worker threads, the calling thread also takes part in every job
+class JobSystem
+{
+	std::vector<std::thread> workers;
+	std::mutex mutex;
+	std::condition_variable jobReady;
+	std::condition_variable jobDone;
+	const std::function<void(int, int)>* job;
+	int jobSize;
+	int chunkSize;
+	std::atomic<int> nextChunk;
+	int busyWorkers;
+	unsigned int jobId;
+	bool stopping;
+
+	void WorkerLoop();
+	void RunChunks();
+public:
+	//threadCount is the number of extra threads, below zero uses one less than the hardware threads
+	JobSystem(int threadCount = -1);
+	~JobSystem();
+	int GetThreadCount() const;
+	//Calls job(begin, end) over [0, count) in chunks of chunkSize, returns when every chunk is done
+	void ParallelFor(int count, int chunkSize, const std::function<void(int, int)>& job);
+};
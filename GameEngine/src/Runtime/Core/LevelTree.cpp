@@ -1,5 +1,7 @@
 #include "LevelTree.h"
 
+#include <iterator>
+
 #include <entt/entity/registry.hpp>
 
 #include "Core/Systems.h"
@@ -10,24 +12,180 @@
 #include "Core/Log.h"
 #include <Core/Assert.h>
 
-LevelTree::LevelTree(entt::entity rootEntity)
+LevelTree::LevelTree(entt::registry& registry, entt::entity rootEntity)
 {
-	root = new Node<entt::entity>(rootEntity);
-	nodesMap[root->element] = root;
+	this->registry = &registry;
+	nodes.push_back({rootEntity, -1, -1, -1, -1, -1, 0, 0});
+	nodeNames.push_back("");
+
+	registry.on_update<GUIDComponent>().connect<&LevelTree::NameChanged>(this);
 }
 LevelTree::~LevelTree()
 {
-	if(root != nullptr && root->element == NoEntity())
+}
+int LevelTree::GetNodeIndex(entt::entity entity) const
+{
+	if(entity == nodes[0].entity)
+	{
+		return 0;
+	}
+	auto index = entt::to_entity(entity);
+	if(index >= entityNodes.size())
+	{
+		return -1;
+	}
+	int node = entityNodes[index];
+	if(node < 0 || nodes[node].entity != entity)
+	{
+		return -1;
+	}
+	return node;
+}
+int LevelTree::AllocateNode(entt::entity entity)
+{
+	int node;
+	if(!freeNodes.empty())
+	{
+		node = freeNodes.back();
+		freeNodes.pop_back();
+	} else
+	{
+		node = nodes.size();
+		nodes.emplace_back();
+		nodeNames.emplace_back();
+	}
+	nodes[node] = {entity, -1, -1, -1, -1, -1, 0, 0};
+	auto guid = registry->try_get<GUIDComponent>(entity);
+	nodeNames[node] = guid != nullptr ? guid->name : "";
+	auto index = entt::to_entity(entity);
+	if(index >= entityNodes.size())
+	{
+		entityNodes.resize(index + 1, -1);
+	}
+	entityNodes[index] = node;
+	return node;
+}
+void LevelTree::Link(int node, int parent)
+{
+	Unlink(node);
+	auto& parentNode = nodes[parent];
+	nodes[node].parent = parent;
+	nodes[node].prevSibling = parentNode.lastChild;
+	if(parentNode.lastChild >= 0)
+	{
+		nodes[parentNode.lastChild].nextSibling = node;
+	} else
+	{
+		parentNode.firstChild = node;
+	}
+	parentNode.lastChild = node;
+	parentNode.childCount++;
+	if(nodes[node].firstChild < 0)
+	{
+		nodes[node].depth = parentNode.depth + 1;
+	} else
+	{
+		UpdateDepths(node);
+	}
+	IndexName(node);
+}
+void LevelTree::Unlink(int node)
+{
+	auto& linked = nodes[node];
+	if(linked.parent < 0)
+	{
+		return;
+	}
+	UnindexName(node);
+	auto& parentNode = nodes[linked.parent];
+	if(linked.prevSibling >= 0)
+	{
+		nodes[linked.prevSibling].nextSibling = linked.nextSibling;
+	} else
+	{
+		parentNode.firstChild = linked.nextSibling;
+	}
+	if(linked.nextSibling >= 0)
+	{
+		nodes[linked.nextSibling].prevSibling = linked.prevSibling;
+	} else
+	{
+		parentNode.lastChild = linked.prevSibling;
+	}
+	parentNode.childCount--;
+	linked.parent = -1;
+	linked.prevSibling = -1;
+	linked.nextSibling = -1;
+}
+void LevelTree::IndexName(int node)
+{
+	if(nodeNames[node].empty())
+	{
+		return;
+	}
+	childNames.emplace(ChildName{nodes[node].parent, nodeNames[node]}, node);
+	entityNames.emplace(nodeNames[node], node);
+}
+void LevelTree::UnindexName(int node)
+{
+	if(nodeNames[node].empty())
+	{
+		return;
+	}
+	auto range = childNames.equal_range(ChildName{nodes[node].parent, nodeNames[node]});
+	for(auto it = range.first; it != range.second; it++)
+	{
+		if(it->second == node)
+		{
+			childNames.erase(it);
+			break;
+		}
+	}
+	auto named = entityNames.equal_range(nodeNames[node]);
+	for(auto it = named.first; it != named.second; it++)
+	{
+		if(it->second == node)
+		{
+			entityNames.erase(it);
+			break;
+		}
+	}
+}
+void LevelTree::NameChanged(entt::registry& registry, entt::entity entity)
+{
+	int node = GetNodeIndex(entity);
+	if(node <= 0)
+	{
+		return;
+	}
+	const auto& name = registry.get<GUIDComponent>(entity).name;
+	if(nodeNames[node] == name)
+	{
+		return;
+	}
+	if(nodes[node].parent >= 0)
+	{
+		UnindexName(node);
+		nodeNames[node] = name;
+		IndexName(node);
+	} else
 	{
-		delete root;
-		root = nullptr;
+		nodeNames[node] = name;
 	}
 }
-Node<entt::entity>* LevelTree::GetParentNode(entt::entity entity)
+void LevelTree::UpdateDepths(int node)
 {
-	auto& entities = ROSE_GETSYSTEM(EntitySystem);
-	auto guidComp = entities.GetRegistry().get<GUIDComponent>(entity);
-	return nodesMap[guidComp.parent];
+	std::vector<int> stack = {node};
+	while(!stack.empty())
+	{
+		int current = stack.back();
+		stack.pop_back();
+		nodes[current].depth = nodes[nodes[current].parent].depth + 1;
+		for(int child = nodes[current].firstChild; child >= 0; child = nodes[child].nextSibling)
+		{
+			stack.push_back(child);
+		}
+	}
 }
 void LevelTree::RemoveParent(entt::entity entity)
 {
@@ -35,18 +193,16 @@ void LevelTree::RemoveParent(entt::entity entity)
 	auto& childGuid = registry.get<GUIDComponent>(entity);
 	if(childGuid.parent != NoEntity())
 	{
-		auto& childTrx = registry.get<TransformComponent>(entity);
-		auto& transformSystem = ROSE_GETSYSTEM(TransformSystem);
 		childGuid.parent = NoEntity();
 		childGuid.parentId = -1;
-		root->AddChild(nodesMap[entity]);
+		Link(GetNodeIndex(entity), 0);
 		registry.patch<GUIDComponent>(entity);
 		ROSE_LOG("removing parent");
 	}
 }
 bool LevelTree::TrySetParent(entt::entity child, entt::entity parent)
 {
-	if(IsChildOf(child, parent))
+	if(child == parent || IsChildOf(child, parent))
 	{
 		return false;
 	}
@@ -60,101 +216,192 @@ bool LevelTree::TrySetParent(entt::entity child, entt::entity parent)
 
 	childGuid.parent = parent;
 	childGuid.parentId = ROSE_GETSYSTEM(EntitySystem).GetEntityGuid(parent);
-	auto node = nodesMap[child];
-	nodesMap[parent]->AddChild(node);
+	Link(GetNodeIndex(child), GetNodeIndex(parent));
 	registry.patch<GUIDComponent>(child);
 	ROSE_LOG("parent set");
 	return true;
 }
 bool LevelTree::IsChildOf(entt::entity entity, entt::entity child)
 {
-	auto node = nodesMap[entity];
-	auto childNode = nodesMap[child];
-
-	if(node->children.find(childNode) != node->children.end())
+	int node = GetNodeIndex(entity);
+	int childNode = GetNodeIndex(child);
+	if(node < 0 || childNode < 0)
 	{
-		return true;
-	} else
+		return false;
+	}
+	for(int current = nodes[childNode].parent; current >= 0 && nodes[current].depth >= nodes[node].depth; current = nodes[current].parent)
 	{
-		for(auto childNode : node->children)
+		if(current == node)
 		{
-			if(IsChildOf(childNode->element, child))
-			{
-				return true;
-			}
+			return true;
 		}
 	}
 	return false;
 }
 void LevelTree::Clear()
 {
-	root->DeleteChildren();
-	nodesMap.clear();
+	nodes.resize(1);
+	nodeNames.resize(1);
+	childNames.clear();
+	entityNames.clear();
+	nodes[0].firstChild = -1;
+	nodes[0].lastChild = -1;
+	nodes[0].childCount = 0;
+	freeNodes.clear();
+	entityNodes.clear();
 }
-Node<entt::entity>* LevelTree::GetRoot()
+bool LevelTree::Contains(entt::entity entity) const
 {
-	return root;
+	return GetNodeIndex(entity) >= 0;
 }
-entt::entity LevelTree::GetChild(entt::entity entity, const std::string& name)
+entt::entity LevelTree::GetFirstChild(entt::entity entity) const
 {
-	auto& registry = ROSE_GETSYSTEM(EntitySystem).GetRegistry();
-	if(!registry.valid(entity))
+	int node = GetNodeIndex(entity);
+	if(node < 0 || nodes[node].firstChild < 0)
 	{
 		return NoEntity();
 	}
-	if(nodesMap.find(entity) == nodesMap.end())
+	return nodes[nodes[node].firstChild].entity;
+}
+entt::entity LevelTree::GetNextSibling(entt::entity entity) const
+{
+	int node = GetNodeIndex(entity);
+	if(node < 0 || nodes[node].nextSibling < 0)
 	{
 		return NoEntity();
 	}
-	auto node = nodesMap[entity];
-	for(auto child : node->children)
+	return nodes[nodes[node].nextSibling].entity;
+}
+entt::entity LevelTree::GetParent(entt::entity entity) const
+{
+	int node = GetNodeIndex(entity);
+	if(node <= 0 || nodes[node].parent < 0)
 	{
-		if(!registry.valid(child->element))
-		{
-			continue;
-		}
-		if(registry.get<GUIDComponent>(child->element).name == name)
+		return NoEntity();
+	}
+	return nodes[nodes[node].parent].entity;
+}
+int LevelTree::GetChildCount(entt::entity entity) const
+{
+	int node = GetNodeIndex(entity);
+	if(node < 0)
+	{
+		return 0;
+	}
+	return nodes[node].childCount;
+}
+int LevelTree::GetDepth(entt::entity entity) const
+{
+	int node = GetNodeIndex(entity);
+	if(node < 0)
+	{
+		return -1;
+	}
+	return nodes[node].depth;
+}
+entt::entity LevelTree::FindChild(int node, const std::string& name) const
+{
+	auto range = childNames.equal_range(ChildName{node, name});
+	if(range.first == range.second)
+	{
+		return NoEntity();
+	}
+	if(std::next(range.first) == range.second)
+	{
+		return nodes[range.first->second].entity;
+	}
+	//Siblings sharing a name resolve to the first one in sibling order
+	for(int child = nodes[node].firstChild; child >= 0; child = nodes[child].nextSibling)
+	{
+		if(nodeNames[child] == name)
 		{
-			return child->element;
+			return nodes[child].entity;
 		}
 	}
 	return NoEntity();
 }
-entt::entity LevelTree::FindEntity(const std::string& name)
+entt::entity LevelTree::GetChild(entt::entity entity, const std::string& name)
 {
 	auto& registry = ROSE_GETSYSTEM(EntitySystem).GetRegistry();
-	auto node = root;
-	for(auto child : node->children)
+	if(!registry.valid(entity))
+	{
+		return NoEntity();
+	}
+	int node = GetNodeIndex(entity);
+	if(node < 0)
+	{
+		return NoEntity();
+	}
+	return FindChild(node, name);
+}
+entt::entity LevelTree::FindEntity(const std::string& name)
+{
+	auto entity = FindChild(0, name);
+	if(entity != NoEntity())
+	{
+		return entity;
+	}
+	int found = -1;
+	auto range = entityNames.equal_range(name);
+	for(auto it = range.first; it != range.second; it++)
 	{
-		if(registry.get<GUIDComponent>(child->element).name == name)
+		if(found < 0 || nodes[it->second].depth < nodes[found].depth)
 		{
-			return child->element;
+			found = it->second;
 		}
 	}
-	return NoEntity();
+	return found < 0 ? NoEntity() : nodes[found].entity;
 }
-Node<entt::entity>* LevelTree::GetNode(entt::entity entity)
+void LevelTree::FindEntities(const std::string& name, std::vector<entt::entity>& entities) const
 {
-	if(nodesMap.find(entity) == nodesMap.end())
+	auto range = entityNames.equal_range(name);
+	for(auto it = range.first; it != range.second; it++)
 	{
-		return nullptr;
+		entities.push_back(nodes[it->second].entity);
 	}
-	return nodesMap[entity];
 }
-Node<entt::entity>* LevelTree::AddEntity(entt::entity entity, Node<entt::entity>* parent)
+void LevelTree::AddEntity(entt::entity entity, entt::entity parent)
 {
-	if(parent == nullptr)
+	int parentNode = GetNodeIndex(parent);
+	if(parentNode < 0)
 	{
-		parent = root;
+		parentNode = 0;
+	}
+	Link(AllocateNode(entity), parentNode);
+}
+void LevelTree::AddEntities(const entt::entity* entities, int count, entt::entity parent)
+{
+	int parentNode = GetNodeIndex(parent);
+	if(parentNode < 0)
+	{
+		parentNode = 0;
+	}
+	int newNodes = count - (int)freeNodes.size();
+	if(newNodes > 0)
+	{
+		nodes.reserve(nodes.size() + newNodes);
+		nodeNames.reserve(nodeNames.size() + newNodes);
+	}
+	for(int i = 0; i < count; i++)
+	{
+		Link(AllocateNode(entities[i]), parentNode);
 	}
-	auto node = new Node<entt::entity>(entity, parent);
-	nodesMap[entity] = node;
-	return node;
 }
 
 void LevelTree::RemoveEntity(entt::entity entity)
 {
-	nodesMap[entity]->parent->RemoveChild(nodesMap[entity]);
-	delete nodesMap[entity];
-	nodesMap.erase(entity);
-}
+	int node = GetNodeIndex(entity);
+	if(node <= 0)
+	{
+		return;
+	}
+	//Children that were not removed first are moved to the root
+	while(nodes[node].firstChild >= 0)
+	{
+		Link(nodes[node].firstChild, 0);
+	}
+	Unlink(node);
+	entityNodes[entt::to_entity(entity)] = -1;
+	nodes[node].entity = NoEntity();
+	freeNodes.push_back(node);
+}
\ No newline at end of file
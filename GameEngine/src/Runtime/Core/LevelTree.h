@@ -1,31 +1,96 @@
 #pragma once
 
-#include <entt/entity/entity.hpp>
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <functional>
 
-#include "Structures/Tree.h"
+#include <entt/entity/entity.hpp>
 
 #include "Core/Entity.h"
 
 #include "Components/TransformComponent.h"
 
+//Tree node stored by index in the level tree's pool, children are kept in insertion order
+struct LevelNode
+{
+	entt::entity entity;
+	int parent;
+	int firstChild;
+	int lastChild;
+	int prevSibling;
+	int nextSibling;
+	int childCount;
+	int depth;
+};
+
+//Key of the child name index, a child is found by its parent node and name
+struct ChildName
+{
+	int parent;
+	std::string name;
+
+	bool operator==(const ChildName& other) const
+	{
+		return parent == other.parent && name == other.name;
+	}
+};
+
+struct ChildNameHash
+{
+	size_t operator()(const ChildName& key) const
+	{
+		return std::hash<std::string>()(key.name) ^ (std::hash<int>()(key.parent) * 31);
+	}
+};
+
 class LevelTree
 {
-	Node<entt::entity>* root;
-	std::unordered_map<entt::entity, Node<entt::entity>*> nodesMap;
+	entt::registry* registry;
+	//nodes[0] is the root, freed nodes are reused before the pool grows
+	std::vector<LevelNode> nodes;
+	std::vector<int> freeNodes;
+	std::vector<int> entityNodes;
+	//Names as they were indexed, kept per node so renamed entities can be found in the index.
+	//Unnamed entities are not indexed, bulk spawned entities would all share one key
+	std::vector<std::string> nodeNames;
+	std::unordered_multimap<ChildName, int, ChildNameHash> childNames;
+	//Every named node by name alone, for lookups anywhere in the tree
+	std::unordered_multimap<std::string, int> entityNames;
 
-	Node<entt::entity>* GetParentNode(entt::entity trx);
+	int GetNodeIndex(entt::entity entity) const;
+	entt::entity FindChild(int node, const std::string& name) const;
+	void IndexName(int node);
+	void UnindexName(int node);
+	void NameChanged(entt::registry& registry, entt::entity entity);
+	int AllocateNode(entt::entity entity);
+	void Link(int node, int parent);
+	void Unlink(int node);
+	void UpdateDepths(int node);
 
 public:
-	Node<entt::entity>* AddEntity(entt::entity entity, Node<entt::entity>* parent = nullptr);
+	void AddEntity(entt::entity entity, entt::entity parent = NoEntity());
+	void AddEntities(const entt::entity* entities, int count, entt::entity parent = NoEntity());
 	void RemoveEntity(entt::entity entity);
-	LevelTree(entt::entity rootEntity = NoEntity());
+	//Built by EntitySystem before it is registered, so the registry is passed in
+	LevelTree(entt::registry& registry, entt::entity rootEntity = NoEntity());
 	~LevelTree();
 	void RemoveParent(entt::entity);
 	bool TrySetParent(entt::entity child, entt::entity parent);
+	//Whether child is a descendant of entity, walks up from child so the cost is its depth
 	bool IsChildOf(entt::entity entity, entt::entity child);
 	void Clear();
-	Node<entt::entity>* GetRoot();
+	bool Contains(entt::entity entity) const;
+	//Children are visited with GetFirstChild and GetNextSibling until NoEntity, the root's children are the children of NoEntity
+	entt::entity GetFirstChild(entt::entity entity) const;
+	entt::entity GetNextSibling(entt::entity entity) const;
+	//Returns NoEntity for entities at the root
+	entt::entity GetParent(entt::entity entity) const;
+	int GetChildCount(entt::entity entity) const;
+	int GetDepth(entt::entity entity) const;
 	entt::entity GetChild(entt::entity entity, const std::string& name);
+	//Entities at the root come first, otherwise the shallowest entity with the name anywhere in the tree
 	entt::entity FindEntity(const std::string& name);
-	Node<entt::entity>* GetNode(entt::entity entity);
-};
\ No newline at end of file
+	//Appends every entity with the name
+	void FindEntities(const std::string& name, std::vector<entt::entity>& entities) const;
+};
@@ -3,10 +3,13 @@
 #include <SDL2/SDL2_gfxPrimitives.h>
 #include <entt/entity/registry.hpp>
 
+#include <algorithm>
+
 #include "Core/SdlContainer.h"
 #include "Core/Entity.h"
 
 #include "Core/LevelTree.h"
+#include "Core/JobSystem.h"
 
 #include "Core/Systems.h"
 
@@ -14,15 +17,22 @@
 
 #include "Core/Log.h"
 
+const int TRANSFORM_BATCH_SIZE = 64;
+const int TRANSFORM_CHUNK_SIZE = 512;
+//Levels smaller than this are not worth waking the workers for
+const int PARALLEL_LEVEL_CUTOFF = 2048;
+
 TransformSystem::TransformSystem()
 {
 	debugDrawer = nullptr;
 	drawDebug = false;
+	hierarchyChanged = true;
 
 	entt::registry& registry = ROSE_GETSYSTEM(EntitySystem).GetRegistry();
 	registry.on_construct<TransformComponent>().connect<&TransformSystem::TransformCreated>(this);
 	registry.on_destroy<TransformComponent>().connect<&TransformSystem::TransformDestroyed>(this);
 	registry.on_update<GUIDComponent>().connect<&TransformSystem::ParentUpdated>(this);
+	registry.on_update<TransformComponent>().connect<&TransformSystem::TransformUpdated>(this);
 }
 TransformSystem::~TransformSystem()
 {
@@ -42,6 +52,9 @@ void TransformSystem::TransformCreated(entt::registry& registry, entt::entity en
 		trx.level = parentTrx.level + 1;
 	}
 	trx.UpdateGlobals();
+	trx.dirty = false;
+	hierarchyChanged = true;
+	MarkDirty(entity);
 }
 entt::entity TransformSystem::GetChild(entt::entity entity, const std::string& name)
 {
@@ -50,6 +63,7 @@ entt::entity TransformSystem::GetChild(entt::entity entity, const std::string& n
 
 void TransformSystem::TransformDestroyed(entt::registry& registry, entt::entity entity)
 {
+	hierarchyChanged = true;
 }
 
 void TransformSystem::ParentUpdated(entt::registry& registry, entt::entity entity)
@@ -68,6 +82,21 @@ void TransformSystem::ParentUpdated(entt::registry& registry, entt::entity entit
 			trx.level = parentTrx.level + 1;
 			MoveTransformToParentSpace(trx, parentTrx);
 		}
+		hierarchyChanged = true;
+		MarkDirty(entity);
+	}
+}
+void TransformSystem::TransformUpdated(entt::registry& registry, entt::entity entity)
+{
+	MarkDirty(entity);
+}
+void TransformSystem::MarkDirty(entt::entity entity)
+{
+	auto& trx = ROSE_GETSYSTEM(EntitySystem).GetRegistry().get<TransformComponent>(entity);
+	if(!trx.dirty)
+	{
+		trx.dirty = true;
+		dirtyTransforms.push_back(entity);
 	}
 }
 void TransformSystem::MoveTransformToWorldSpace(TransformComponent& trx)
@@ -79,8 +108,7 @@ void TransformSystem::MoveTransformToWorldSpace(TransformComponent& trx)
 }
 void TransformSystem::MoveTransformToParentSpace(TransformComponent& child, TransformComponent& parent)
 {
-	auto matrixW2sL = glm::inverse(parent.matrixL2W);
-	auto matrixtL2sL = child.matrixL2W * matrixW2sL;
+	auto matrixtL2sL = (child.matrixL2W * parent.matrixL2W.Inverse()).ToMat3();
 	child.position = TransformComponent::GetPosition(matrixtL2sL);
 	child.scale = TransformComponent::GetScale(matrixtL2sL);
 	child.rotation = TransformComponent::GetRotation(matrixtL2sL);
@@ -90,18 +118,181 @@ void TransformSystem::Update()
 {
 	entt::registry& registry = ROSE_GETSYSTEM(EntitySystem).GetRegistry();
 
-	registry.sort<TransformComponent>([](const auto& lhs, const auto& rhs)
+	int firstDirty = hierarchy.Size();
+	if(hierarchyChanged)
+	{
+		RebuildHierarchy(registry);
+		firstDirty = 0;
+	}
+	for(auto entity : dirtyTransforms)
+	{
+		auto index = GetHierarchyIndex(entity);
+		if(index < 0)
+		{
+			continue;
+		}
+		ReadLocals(index);
+		hierarchy.dirty[index] = 1;
+		firstDirty = std::min(firstDirty, index);
+	}
+	dirtyTransforms.clear();
+
+	//Levels are calculated in order, a transform is dirty if it was marked or its parent was recalculated.
+	//Transforms within a level only read their parents, so large levels are split across the job system
+	auto& jobs = ROSE_GETSYSTEM(JobSystem);
+	for(int level = 0; level + 1 < hierarchy.levelStarts.size(); level++)
+	{
+		int begin = std::max(hierarchy.levelStarts[level], firstDirty);
+		int end = hierarchy.levelStarts[level + 1];
+		if(end - begin >= PARALLEL_LEVEL_CUTOFF)
+		{
+			jobs.ParallelFor(end - begin, TRANSFORM_CHUNK_SIZE, [this, begin](int chunkBegin, int chunkEnd)
+				{
+					UpdateRange(begin + chunkBegin, begin + chunkEnd);
+				});
+		} else if(begin < end)
+		{
+			UpdateRange(begin, end);
+		}
+	}
+	std::fill(hierarchy.dirty.begin() + firstDirty, hierarchy.dirty.end(), 0);
+}
+void TransformSystem::UpdateRange(int begin, int end)
+{
+	//Dirty transforms are gathered into small batches for the compose kernel
+	Affine locals[TRANSFORM_BATCH_SIZE];
+	Affine parents[TRANSFORM_BATCH_SIZE];
+	Affine worlds[TRANSFORM_BATCH_SIZE];
+	int indices[TRANSFORM_BATCH_SIZE];
+	int count = 0;
+	auto flush = [&]()
 		{
-			return lhs.level < rhs.level;
-		});
-	auto view3 = registry.view<TransformComponent>();
-	for(auto entity : view3)
+			ComposeAffines(locals, parents, worlds, count);
+			for(int b = 0; b < count; b++)
+			{
+				int index = indices[b];
+				int parent = hierarchy.parents[index];
+				auto scale = hierarchy.scales[index];
+				auto scaleSign = vec2(sign(scale.x), sign(scale.y));
+				hierarchy.scaleSigns[index] = parent < 0 ? scaleSign : hierarchy.scaleSigns[parent] * scaleSign;
+				hierarchy.worlds[index] = worlds[b];
+				WriteGlobals(index);
+			}
+			count = 0;
+		};
+	for(int i = begin; i < end; i++)
 	{
-		auto& trx = view3.get<TransformComponent>(entity);
-		trx.CalcMatrix();
-		trx.UpdateGlobals();
+		int parent = hierarchy.parents[i];
+		if(!hierarchy.dirty[i])
+		{
+			if(parent < 0 || !hierarchy.dirty[parent])
+			{
+				continue;
+			}
+			hierarchy.dirty[i] = 1;
+		}
+		indices[count] = i;
+		locals[count] = hierarchy.locals[i];
+		parents[count] = parent < 0 ? Affine() : hierarchy.worlds[parent];
+		count++;
+		if(count == TRANSFORM_BATCH_SIZE)
+		{
+			flush();
+		}
+	}
+	if(count > 0)
+	{
+		flush();
 	}
 }
+void TransformSystem::RebuildHierarchy(entt::registry& registry)
+{
+	hierarchy.Clear();
+	std::fill(hierarchyIndices.begin(), hierarchyIndices.end(), -1);
+	auto& transforms = registry.storage<TransformComponent>();
+
+	struct QueuedNode
+	{
+		entt::entity entity;
+		int parent;
+		int depth;
+	};
+	auto& levelTree = ROSE_GETSYSTEM(LevelTree);
+	std::vector<QueuedNode> queue;
+	queue.push_back({NoEntity(), -1, -1});
+	for(int head = 0; head < queue.size(); head++)
+	{
+		auto queued = queue[head];
+		int index = queued.parent;
+		auto entity = queued.entity;
+		if(entity != NoEntity() && transforms.contains(entity))
+		{
+			if(queued.depth >= hierarchy.levelStarts.size())
+			{
+				hierarchy.levelStarts.push_back(hierarchy.Size());
+			}
+			index = hierarchy.Add(entity, &transforms.get(entity), queued.parent);
+			auto entityIndex = entt::to_entity(entity);
+			if(entityIndex >= hierarchyIndices.size())
+			{
+				hierarchyIndices.resize(entityIndex + 1, -1);
+			}
+			hierarchyIndices[entityIndex] = index;
+			hierarchy.components[index]->level = queued.depth;
+			ReadLocals(index);
+		}
+		for(auto child = levelTree.GetFirstChild(entity); child != NoEntity(); child = levelTree.GetNextSibling(child))
+		{
+			queue.push_back({child, index, queued.depth + 1});
+		}
+	}
+	hierarchy.levelStarts.push_back(hierarchy.Size());
+	std::fill(hierarchy.dirty.begin(), hierarchy.dirty.end(), 1);
+	hierarchyChanged = false;
+}
+void TransformSystem::ReadLocals(int index)
+{
+	auto& trx = *hierarchy.components[index];
+	trx.rotation = glm::mod(trx.rotation + 360, 360.0f);
+	hierarchy.positions[index] = trx.position;
+	hierarchy.scales[index] = trx.scale;
+	hierarchy.rotations[index] = trx.rotation;
+	hierarchy.locals[index] = Affine::FromTRS(trx.position, trx.scale, trx.rotation);
+}
+void TransformSystem::WriteGlobals(int index)
+{
+	auto& trx = *hierarchy.components[index];
+	trx.matrixL2W = hierarchy.worlds[index];
+	auto matrix = trx.matrixL2W.ToMat3();
+	trx.globalPosition = TransformComponent::GetPosition(matrix);
+	trx.globalScale = TransformComponent::GetScale(matrix);
+	trx.globalRotation = TransformComponent::GetRotation(matrix);
+	trx.scaleSign = hierarchy.scaleSigns[index];
+	trx.dirty = false;
+	trx.version++;
+}
+int TransformSystem::GetHierarchyIndex(entt::entity entity) const
+{
+	auto entityIndex = entt::to_entity(entity);
+	if(entityIndex >= hierarchyIndices.size())
+	{
+		return -1;
+	}
+	int index = hierarchyIndices[entityIndex];
+	if(index < 0 || hierarchy.entities[index] != entity)
+	{
+		return -1;
+	}
+	return index;
+}
+const std::vector<entt::entity>& TransformSystem::GetOrderedEntities()
+{
+	if(hierarchyChanged)
+	{
+		RebuildHierarchy(ROSE_GETSYSTEM(EntitySystem).GetRegistry());
+	}
+	return hierarchy.entities;
+}
 
 glm::mat3 TransformSystem::CalcMatrix(TransformComponent& trx)
 {
@@ -159,8 +350,9 @@ void DebugDrawTransform::SetMatrix(glm::mat3 worldToScreen)
 void DebugDrawTransform::DrawTransform(const TransformComponent& t, bool selected)
 {
 	float scale = 1 - (0.2 * t.level);
-	auto orig = TransformComponent::GetPosition(t.matrixL2W * matrix, vec2(0, 0));
-	auto dir = TransformComponent::GetDir(t.matrixL2W * matrix, vec2(0, 1));
+	auto matrixL2S = t.matrixL2W.ToMat3() * matrix;
+	auto orig = TransformComponent::GetPosition(matrixL2S, vec2(0, 0));
+	auto dir = TransformComponent::GetDir(matrixL2S, vec2(0, 1));
 	dir = normalize(dir) * 100.0f;
 	auto dest = orig + dir * scale;
 	if(selected)
@@ -173,3 +365,36 @@ void DebugDrawTransform::DrawTransform(const TransformComponent& t, bool selecte
 		thickLineRGBA(renderer, orig.x, orig.y, dest.x, dest.y, 10 * scale, 20, 100, 30, 200);
 	}
 }
+
+void TransformHierarchy::Clear()
+{
+	entities.clear();
+	components.clear();
+	parents.clear();
+	positions.clear();
+	scales.clear();
+	rotations.clear();
+	scaleSigns.clear();
+	locals.clear();
+	worlds.clear();
+	dirty.clear();
+	levelStarts.clear();
+}
+int TransformHierarchy::Add(entt::entity entity, TransformComponent* trx, int parent)
+{
+	entities.push_back(entity);
+	components.push_back(trx);
+	parents.push_back(parent);
+	positions.push_back(trx->position);
+	scales.push_back(trx->scale);
+	rotations.push_back(trx->rotation);
+	scaleSigns.push_back(vec2(1, 1));
+	locals.push_back(Affine());
+	worlds.push_back(Affine());
+	dirty.push_back(1);
+	return entities.size() - 1;
+}
+int TransformHierarchy::Size() const
+{
+	return entities.size();
+}
@@ -3,6 +3,10 @@
 #include <glm/glm.hpp>
 #include <entt/entity/entity.hpp>
 
+#include <vector>
+
+#include "Core/Affine.h"
+
 #include "Components/TransformComponent.h"
 
 class DebugDrawTransform
@@ -15,21 +19,57 @@ public:
 	void DrawTransform(const TransformComponent& t, bool selected);
 };
 
+//Flat copy of the transform hierarchy in breadth first order, parents always come before their children.
+//Each depth is a contiguous range starting at levelStarts[depth]
+struct TransformHierarchy
+{
+	std::vector<entt::entity> entities;
+	std::vector<TransformComponent*> components;
+	std::vector<int> parents;
+	std::vector<glm::vec2> positions;
+	std::vector<glm::vec2> scales;
+	std::vector<float> rotations;
+	std::vector<glm::vec2> scaleSigns;
+	std::vector<Affine> locals;
+	std::vector<Affine> worlds;
+	std::vector<unsigned char> dirty;
+	std::vector<int> levelStarts;
+
+	void Clear();
+	int Add(entt::entity entity, TransformComponent* trx, int parent);
+	int Size() const;
+};
+
 class TransformSystem
 {
 	void TransformCreated(entt::registry& registry, entt::entity);
 	void TransformDestroyed(entt::registry& registry, entt::entity);
 	void ParentUpdated(entt::registry& registry, entt::entity);
+	void TransformUpdated(entt::registry& registry, entt::entity);
+	void RebuildHierarchy(entt::registry& registry);
+	void ReadLocals(int index);
+	void UpdateRange(int begin, int end);
+	void WriteGlobals(int index);
+	int GetHierarchyIndex(entt::entity entity) const;
+	std::vector<entt::entity> dirtyTransforms;
+	TransformHierarchy hierarchy;
+	std::vector<int> hierarchyIndices;
+	bool hierarchyChanged;
 	DebugDrawTransform* debugDrawer;
 	bool drawDebug;
 public:
 	TransformSystem();
 	~TransformSystem();
 	void Update();
+	//Queues the transform and its descendants for recalculation in the next Update.
+	//Patching the TransformComponent does the same
+	void MarkDirty(entt::entity entity);
 	void InitDebugDrawer();
 	void EnableDebug(bool enable);
 	void DebugRender(glm::mat3 viewMatrix, entt::entity selectedEntity);
 	entt::entity GetChild(entt::entity entity, const std::string& name);
+	//All entities with a transform, parents before their children
+	const std::vector<entt::entity>& GetOrderedEntities();
 	static void MoveTransformToWorldSpace(TransformComponent& trx);
 	static void MoveTransformToParentSpace(TransformComponent& trx, TransformComponent& source);
 	static glm::mat3 CalcMatrix(TransformComponent& trx);
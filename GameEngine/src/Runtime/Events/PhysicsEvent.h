@@ -1,14 +1,32 @@
 #pragma once
+#include <vector>
+
+#include <entt/entity/entity.hpp>
+
 #include "Event.h"
-#include <box2d/b2_world_callbacks.h>
 
+//Contact recorded during a physics step, entityA is always the lower entity so a pair has one key
+struct PhysicsContact
+{
+	entt::entity entityA;
+	entt::entity entityB;
+	bool begin;
+	bool sensorA;
+	bool sensorB;
+
+	bool operator==(const PhysicsContact& other) const
+	{
+		return entityA == other.entityA && entityB == other.entityB && begin == other.begin && sensorA == other.sensorA && sensorB == other.sensorB;
+	}
+};
+
+//Emitted once after each physics step with that step's contacts, the list is read only so listeners do not depend on each other
 class PhysicsEvent:public Event
 {
 public:
-	b2Contact* contact;
-	bool begin;
-	PhysicsEvent(b2Contact* contact, bool begin):contact(contact), begin(begin)
+	const std::vector<PhysicsContact>& contacts;
+	PhysicsEvent(const std::vector<PhysicsContact>& contacts):contacts(contacts)
 	{
 
 	}
-};
\ No newline at end of file
+};
@@ -1,6 +1,6 @@
 #include "CombatSystem.h"
 
-#include <box2d/b2_contact.h>
+#include <entt/entt.hpp>
 
 #include "Core/Entity.h"
 #include "Core/Systems.h"
@@ -21,34 +21,27 @@ CombatSystem::CombatSystem()
 
 void CombatSystem::OnPhysicsEvent(PhysicsEvent& e)
 {
-	if(e.begin)
+	auto& registry = ROSE_GETSYSTEM(EntitySystem).GetRegistry();
+	auto& events = ROSE_GETSYSTEM(EntityEventSystem);
+	for(auto& contact : e.contacts)
 	{
-		auto entityA = entt::entity(e.contact->GetFixtureA()->GetBody()->GetUserData().pointer);
-		auto entityB = entt::entity(e.contact->GetFixtureB()->GetBody()->GetUserData().pointer);
-
-		auto& registry = ROSE_GETSYSTEM(EntitySystem).GetRegistry();
-		auto& events = ROSE_GETSYSTEM(EntityEventSystem);
-
-		if(registry.any_of<HitBoxComponent>(entityA) && registry.any_of<HurtBoxComponent>(entityB))
+		//Bodies destroyed outside a step end their contacts after the entity is gone
+		if(!contact.begin || !registry.valid(contact.entityA) || !registry.valid(contact.entityB))
 		{
-			auto& hitBox = registry.get<HitBoxComponent>(entityA);
-			auto& hurtBox = registry.get<HurtBoxComponent>(entityB);
-			if(hitBox.faction != hurtBox.faction)
-			{
-				auto entityEvent = EntityEvent(entityB, "Hit");
-				events.QueueEvent(entityEvent);
-			}
+			continue;
 		}
+		TryHit(registry, events, contact.entityA, contact.entityB);
+		TryHit(registry, events, contact.entityB, contact.entityA);
+	}
+}
 
-		if(registry.any_of<HitBoxComponent>(entityB) && registry.any_of<HurtBoxComponent>(entityA))
-		{
-			auto& hitBox = registry.get<HitBoxComponent>(entityB);
-			auto& hurtBox = registry.get<HurtBoxComponent>(entityA);
-			if(hitBox.faction != hurtBox.faction)
-			{
-				auto entityEvent = EntityEvent(entityA, "Hit");
-				events.QueueEvent(entityEvent);
-			}
-		}
+void CombatSystem::TryHit(entt::registry& registry, EntityEventSystem& events, entt::entity hitter, entt::entity target)
+{
+	auto hitBox = registry.try_get<HitBoxComponent>(hitter);
+	auto hurtBox = registry.try_get<HurtBoxComponent>(target);
+	if(hitBox != nullptr && hurtBox != nullptr && hitBox->faction != hurtBox->faction)
+	{
+		auto entityEvent = EntityEvent(target, "Hit");
+		events.QueueEvent(entityEvent);
 	}
 }
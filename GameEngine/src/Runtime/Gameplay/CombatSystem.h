@@ -1,9 +1,14 @@
 #pragma once
+#include <entt/entity/fwd.hpp>
+
 #include "Events/EventBus.h"
 #include "Events/PhysicsEvent.h"
 
+class EntityEventSystem;
+
 class CombatSystem
 {
+	void TryHit(entt::registry& registry, EntityEventSystem& events, entt::entity hitter, entt::entity target);
 public:
 	CombatSystem();
 	void OnPhysicsEvent(PhysicsEvent& e);
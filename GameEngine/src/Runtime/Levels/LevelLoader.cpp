@@ -8,6 +8,11 @@
 
 #include "Core/Systems.h"
 #include "Core/Guid.h"
+#include "Core/Transform.h"
+#include "Core/LevelTree.h"
+#include "Levels/PrefabSystem.h"
+#include "Physics/Physics.h"
+#include "Project/ProjectLoader.h"
 
 #include "Core/FileResource.h"
 
@@ -46,8 +51,19 @@ void LevelLoader::LoadLevel(const std::string& fileName)
 	SDL_RWread(fileHandle.file, &fileString[0], sizeof(fileString[0]), fileString.size());
 	auto tree = ryml::parse_in_arena(ryml::to_csubstr(fileString));
 	auto root = tree.rootref();
+	auto& physics = ROSE_GETSYSTEM(PhysicsSystem);
+	//Bodies are built after parents are resolved so their shapes use the final scale
+	physics.DeferBodies();
 	DeserializeLevel(registry, root);
+	ROSE_GETSYSTEM(TransformSystem).Update();
+	physics.CreateDeferredBodies();
 	loadedLevel = fileName;
+	auto project = ROSE_GETSYSTEM(ProjectLoader).GetCurrentProject();
+	if(project != nullptr)
+	{
+		physics.SetSettings(project->GetPhysicsSettings(fileName));
+	}
+	ROSE_GETSYSTEM(PrefabSystem).CompileAll();
 }
 void LevelLoader::DeserializeLevel(entt::registry& registry, ryml::NodeRef& node)
 {
@@ -104,9 +120,39 @@ void LevelLoader::SaveLevel(const std::string& fileName)
 	std::string buffer = ryml::emitrs_yaml<std::string>(tree);
 	SDL_RWwrite(fileHandle.file, buffer.data(), 1, buffer.size());
 }
+void LevelLoader::SavePrefab(entt::entity entity, const std::string& fileName)
+{
+	auto& registry = ROSE_GETSYSTEM(EntitySystem).GetRegistry();
+	if(!registry.valid(entity))
+	{
+		return;
+	}
+	auto fileHandle = FileResource(fileName, "w+");
+	if(fileHandle.file == nullptr)
+	{
+		ROSE_ERR("Couldnt create file %s", fileName.c_str());
+		return;
+	}
+	auto tree = ryml::Tree();
+	auto root = tree.rootref();
+	root |= ryml::SEQ;
+	auto& levelTree = ROSE_GETSYSTEM(LevelTree);
+	std::vector<entt::entity> subtree = {entity};
+	for(int i = 0; i < subtree.size(); i++)
+	{
+		SerializeEntity(registry, root, subtree[i]);
+		for(auto child = levelTree.GetFirstChild(subtree[i]); child != NoEntity(); child = levelTree.GetNextSibling(child))
+		{
+			subtree.push_back(child);
+		}
+	}
+	std::string buffer = ryml::emitrs_yaml<std::string>(tree);
+	SDL_RWwrite(fileHandle.file, buffer.data(), 1, buffer.size());
+}
 void LevelLoader::UnloadLevel()
 {
 	EntitySystem& entities = ROSE_GETSYSTEM(EntitySystem);
+	ROSE_GETSYSTEM(PrefabSystem).ClearPools();
 	entities.DestroyAllEntities();
 }
 const std::string& LevelLoader::GetCurrentLevelFile()
@@ -116,14 +162,12 @@ const std::string& LevelLoader::GetCurrentLevelFile()
 void LevelLoader::SerializeLevel(entt::registry& registry, ryml::NodeRef& node)
 {
 	node |= ryml::SEQ;
-	registry.sort<TransformComponent>([](const auto& lhs, const auto& rhs)
-		{
-			return lhs.level < rhs.level;
-		});
-	auto view = registry.view<GUIDComponent, TransformComponent>().use<TransformComponent>();
-	for(auto entity : view)
+	//Parents are written before their children so they exist when the children are loaded
+	for(auto entity : ROSE_GETSYSTEM(TransformSystem).GetOrderedEntities())
 	{
-		auto& trx = view.get<TransformComponent>(entity);
-		SerializeEntity(registry, node, entity);
+		if(registry.all_of<GUIDComponent>(entity))
+		{
+			SerializeEntity(registry, node, entity);
+		}
 	}
 }
\ No newline at end of file
@@ -13,6 +13,8 @@ public:
 	~LevelLoader();
 	void LoadLevel(const std::string& fileName);
 	void SaveLevel(const std::string& fileName);
+	//Writes the entity and its children in the level format so the file can be loaded as a prefab asset
+	void SavePrefab(entt::entity entity, const std::string& fileName);
 	void UnloadLevel();
 	const std::string& GetCurrentLevelFile();
 private:
@@ -0,0 +1,488 @@
+#include "Levels/PrefabSystem.h"
+
+#include <unordered_map>
+
+#include <ryml/ryml.hpp>
+#include <ryml/ryml_std.hpp>
+
+#include "Core/Systems.h"
+#include "Core/Entity.h"
+#include "Core/EntitySerializer.h"
+#include "Core/LevelTree.h"
+#include "Core/Transform.h"
+#include "Core/DisableSystem.h"
+#include "Scripting/ScriptSystem.h"
+#include "Core/Log.h"
+#include "AssetPipline/AssetStore.h"
+#include "AssetPipline/PrefabAsset.h"
+
+#include "Components/TransformComponent.h"
+#include "Components/PhysicsBodyComponent.h"
+#include "Components/SpriteComponent.h"
+#include "Components/CameraComponent.h"
+#include "Components/GUIDComponent.h"
+#include "Components/AnimationComponent.h"
+#include "Components/ScriptComponent.h"
+#include "Components/SendEventsToParentComponent.h"
+#include "Components/DisableComponent.h"
+#include "Components/InputComponent.h"
+#include "Components/HitBoxComponent.h"
+#include "Components/HurtBoxComponent.h"
+
+std::unique_ptr<Prefab> PrefabSystem::Compile(const std::string& source)
+{
+	auto tree = ryml::parse_in_arena(ryml::to_csubstr(source));
+	auto root = tree.rootref();
+
+	//Components are deserialized into a registry without hooks and copied out by type
+	entt::registry staging;
+	std::vector<entt::entity> fileEntities;
+	std::vector<Guid> parentIds;
+	std::unordered_map<Guid, int> fileIndices;
+	auto child = root.first_child();
+	for(int i = 0; i < root.num_children(); i++)
+	{
+		if(child.is_map() && child.has_child("Type") && child["Type"] == "Entity")
+		{
+			auto entity = staging.create();
+			Guid id = -1;
+			Guid parentId = -1;
+			if(child.has_child("Guid"))
+			{
+				auto guidNode = child["Guid"];
+				ComponentSer<GUIDComponent>::Deserialize(staging, guidNode, entity);
+				if(guidNode.has_child("id"))
+				{
+					guidNode["id"] >> id;
+				}
+				parentId = staging.get<GUIDComponent>(entity).parentId;
+			} else
+			{
+				staging.emplace<GUIDComponent>(entity);
+			}
+			EntitySerializer::DeserializeEntity(child, staging, entity);
+			if(id != Guid(-1))
+			{
+				fileIndices[id] = fileEntities.size();
+			}
+			fileEntities.push_back(entity);
+			parentIds.push_back(parentId);
+		}
+		child = child.next_sibling();
+	}
+
+	//Entities whose parent is not in the file are roots, the rest are ordered depth first under them
+	std::vector<std::vector<int>> children(fileEntities.size());
+	std::vector<int> stack;
+	for(int i = fileEntities.size() - 1; i >= 0; i--)
+	{
+		auto parent = fileIndices.find(parentIds[i]);
+		if(parent == fileIndices.end() || parent->second == i)
+		{
+			stack.push_back(i);
+		} else
+		{
+			children[parent->second].push_back(i);
+		}
+	}
+	auto prefab = std::make_unique<Prefab>();
+	prefab->transforms = nullptr;
+	prefab->origin = glm::vec2(0, 0);
+	std::vector<int> prefabIndices(fileEntities.size(), -1);
+	std::vector<entt::entity> stagingEntities;
+	while(!stack.empty())
+	{
+		int current = stack.back();
+		stack.pop_back();
+		auto parent = fileIndices.find(parentIds[current]);
+		int prefabParent = parent == fileIndices.end() ? -1 : prefabIndices[parent->second];
+		prefabIndices[current] = prefab->entities.size();
+		prefab->entities.push_back({staging.get<GUIDComponent>(fileEntities[current]).name, prefabParent});
+		stagingEntities.push_back(fileEntities[current]);
+		for(auto it = children[current].begin(); it != children[current].end(); it++)
+		{
+			stack.push_back(*it);
+		}
+	}
+	if(stagingEntities.empty())
+	{
+		return prefab;
+	}
+	auto rootTransform = staging.try_get<TransformComponent>(stagingEntities[0]);
+	if(rootTransform != nullptr)
+	{
+		prefab->origin = rootTransform->position;
+	}
+
+	CompileComponents<DisableComponent>(*prefab, staging, stagingEntities);
+	CompileComponents<TransformComponent>(*prefab, staging, stagingEntities);
+	CompileComponents<PhysicsBodyComponent>(*prefab, staging, stagingEntities);
+	CompileComponents<CameraComponent>(*prefab, staging, stagingEntities);
+	CompileComponents<AnimationComponent>(*prefab, staging, stagingEntities);
+	CompileComponents<SpriteComponent>(*prefab, staging, stagingEntities);
+	CompileComponents<ScriptComponent>(*prefab, staging, stagingEntities);
+	CompileComponents<SendEventsToParentComponent>(*prefab, staging, stagingEntities);
+	CompileComponents<InputComponent>(*prefab, staging, stagingEntities);
+	CompileComponents<HitBoxComponent>(*prefab, staging, stagingEntities);
+	CompileComponents<HurtBoxComponent>(*prefab, staging, stagingEntities);
+	return prefab;
+}
+
+const Prefab* PrefabSystem::GetPrefab(AssetId id)
+{
+	auto& assetStore = ROSE_GETSYSTEM(AssetStore);
+	//Callers keep the id they interned, the compiled prefab follows reloads of the asset
+	auto currentId = assetStore.GetCurrentId(id);
+	auto handle = assetStore.GetAsset(currentId);
+	if(handle.type != AssetType::Prefab || handle.asset == nullptr)
+	{
+		return nullptr;
+	}
+	auto generation = currentId.generation;
+	if(id.index >= prefabs.size())
+	{
+		prefabs.resize(id.index + 1);
+	}
+	auto& prefab = prefabs[id.index];
+	if(prefab == nullptr || prefab->generation != generation)
+	{
+		prefab = Compile(((PrefabAsset*)handle.asset)->source);
+		prefab->generation = generation;
+		ROSE_LOG("Compiled prefab with %d entities", (int)prefab->entities.size());
+	}
+	return prefab.get();
+}
+
+void PrefabSystem::CompileAll()
+{
+	auto& assetStore = ROSE_GETSYSTEM(AssetStore);
+	for(auto& asset : assetStore.GetAssetOfType(AssetType::Prefab))
+	{
+		GetPrefab(assetStore.GetAssetId(asset.first));
+	}
+}
+
+entt::entity PrefabSystem::Spawn(AssetId id, glm::vec2 position)
+{
+	auto roots = Spawn(id, &position, 1);
+	return roots.empty() ? NoEntity() : roots[0];
+}
+
+std::vector<entt::entity> PrefabSystem::Spawn(AssetId id, const glm::vec2* positions, int count)
+{
+	std::vector<entt::entity> roots;
+	auto prefab = GetPrefab(id);
+	if(prefab == nullptr || prefab->entities.empty() || count <= 0)
+	{
+		return roots;
+	}
+	roots.reserve(count);
+	int reused = TakePooled(id, *prefab, count, roots);
+	for(int i = 0; i < reused; i++)
+	{
+		ReuseInstance(*prefab, pooledInstances[roots[i]].entities.data(), positions != nullptr ? positions + i : nullptr);
+	}
+	SpawnInstances(id, *prefab, nullptr, positions != nullptr ? positions + reused : nullptr, count - reused, roots);
+	return roots;
+}
+
+entt::entity PrefabSystem::QueueSpawn(AssetId id, glm::vec2 position)
+{
+	auto roots = QueueSpawn(id, &position, 1);
+	return roots.empty() ? NoEntity() : roots[0];
+}
+
+std::vector<entt::entity> PrefabSystem::QueueSpawn(AssetId id, const glm::vec2* positions, int count)
+{
+	std::vector<entt::entity> roots;
+	auto prefab = GetPrefab(id);
+	if(prefab == nullptr || prefab->entities.empty() || count <= 0)
+	{
+		return roots;
+	}
+	roots.reserve(count);
+	//Pooled instances are taken now so later spawns this frame can not take them too, new instances get a bare root handle
+	int reused = TakePooled(id, *prefab, count, roots);
+	auto& entities = ROSE_GETSYSTEM(EntitySystem);
+	auto& registry = entities.GetRegistry();
+	for(int i = reused; i < count; i++)
+	{
+		roots.push_back(registry.create());
+	}
+	std::vector<glm::vec2> spawnPositions;
+	if(positions != nullptr)
+	{
+		spawnPositions.assign(positions, positions + count);
+	}
+	entities.GetCommands().Spawn([this, id, roots, reused, spawnPositions = std::move(spawnPositions)]()
+		{
+			PlayQueuedSpawn(id, roots, reused, spawnPositions);
+		});
+	return roots;
+}
+
+void PrefabSystem::PlayQueuedSpawn(AssetId id, const std::vector<entt::entity>& roots, int reused, const std::vector<glm::vec2>& positions)
+{
+	auto& entities = ROSE_GETSYSTEM(EntitySystem);
+	auto& registry = entities.GetRegistry();
+	auto prefab = GetPrefab(id);
+	std::vector<entt::entity> staleRoots;
+	if(prefab == nullptr || prefab->entities.empty())
+	{
+		//The reserved roots have no components or tree nodes yet so they are destroyed directly
+		for(int i = reused; i < roots.size(); i++)
+		{
+			if(registry.valid(roots[i]))
+			{
+				registry.destroy(roots[i]);
+			}
+		}
+		staleRoots.assign(roots.begin(), roots.begin() + reused);
+		entities.DestroyEntities(staleRoots);
+		return;
+	}
+	const glm::vec2* spawnPositions = positions.empty() ? nullptr : positions.data();
+	for(int i = 0; i < reused; i++)
+	{
+		auto instance = pooledInstances.find(roots[i]);
+		if(instance != pooledInstances.end() && IsReusable(instance->second, *prefab))
+		{
+			ReuseInstance(*prefab, instance->second.entities.data(), spawnPositions != nullptr ? spawnPositions + i : nullptr);
+		} else
+		{
+			staleRoots.push_back(roots[i]);
+			if(instance != pooledInstances.end())
+			{
+				pooledInstances.erase(instance);
+			}
+		}
+	}
+	entities.DestroyEntities(staleRoots);
+	std::vector<entt::entity> spawned;
+	SpawnInstances(id, *prefab, roots.data() + reused, spawnPositions != nullptr ? spawnPositions + reused : nullptr, roots.size() - reused, spawned);
+}
+
+void PrefabSystem::SpawnInstances(AssetId id, const Prefab& prefab, const entt::entity* reservedRoots, const glm::vec2* positions, int count, std::vector<entt::entity>& roots)
+{
+	if(count <= 0)
+	{
+		return;
+	}
+	auto& entities = ROSE_GETSYSTEM(EntitySystem);
+	auto& registry = entities.GetRegistry();
+	auto& levelTree = ROSE_GETSYSTEM(LevelTree);
+	int entityCount = prefab.entities.size();
+	std::vector<entt::entity> created;
+	if(reservedRoots == nullptr)
+	{
+		created = entities.CreateEntities(count * entityCount);
+	} else
+	{
+		//Each instance keeps its reserved root, the other entities are created now and everything is registered in bulk
+		created.resize(count * entityCount);
+		for(int i = 0; i < count; i++)
+		{
+			auto instance = created.begin() + i * entityCount;
+			instance[0] = reservedRoots[i];
+			registry.create(instance + 1, instance + entityCount);
+		}
+		entities.AddEntities(created.data(), created.size());
+	}
+	bool pooled = id.index < pools.size() && pools[id.index].maxSize > 0;
+
+	//Parents are linked before any transform exists so the transforms are created in parent space
+	for(int i = 0; i < count; i++)
+	{
+		auto instance = created.data() + i * entityCount;
+		roots.push_back(instance[0]);
+		for(int e = 0; e < entityCount; e++)
+		{
+			auto& prefabEntity = prefab.entities[e];
+			registry.get<GUIDComponent>(instance[e]).name = prefabEntity.name;
+			if(prefabEntity.parent >= 0)
+			{
+				levelTree.TrySetParent(instance[e], instance[prefabEntity.parent]);
+			} else
+			{
+				registry.patch<GUIDComponent>(instance[e]);
+			}
+		}
+		if(pooled)
+		{
+			pooledInstances[instance[0]] = {id.index, prefab.generation, false, std::vector<entt::entity>(instance, instance + entityCount)};
+		}
+	}
+	for(auto& components : prefab.components)
+	{
+		components->Instantiate(registry, prefab, created, count, positions);
+	}
+}
+
+bool PrefabSystem::IsReusable(const PooledInstance& instance, const Prefab& prefab)
+{
+	auto& entities = ROSE_GETSYSTEM(EntitySystem);
+	if(instance.generation != prefab.generation)
+	{
+		return false;
+	}
+	for(auto entity : instance.entities)
+	{
+		if(!entities.EntityExists(entity))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+int PrefabSystem::TakePooled(AssetId id, const Prefab& prefab, int count, std::vector<entt::entity>& roots)
+{
+	if(id.index >= pools.size() || pools[id.index].maxSize <= 0)
+	{
+		return 0;
+	}
+	auto& pool = pools[id.index];
+	auto& entities = ROSE_GETSYSTEM(EntitySystem);
+	std::vector<entt::entity> staleRoots;
+	//Instances of an older version of the prefab can not be reused
+	if(pool.generation != prefab.generation)
+	{
+		for(int i = 0; i < pool.roots.size();)
+		{
+			auto instance = pooledInstances.find(pool.roots[i]);
+			if(instance == pooledInstances.end() || instance->second.generation != prefab.generation)
+			{
+				staleRoots.push_back(pool.roots[i]);
+				if(instance != pooledInstances.end())
+				{
+					pooledInstances.erase(instance);
+				}
+				pool.roots[i] = pool.roots.back();
+				pool.roots.pop_back();
+			} else
+			{
+				i++;
+			}
+		}
+		pool.generation = prefab.generation;
+	}
+	int taken = 0;
+	while(taken < count && !pool.roots.empty())
+	{
+		auto root = pool.roots.back();
+		pool.roots.pop_back();
+		auto instance = pooledInstances.find(root);
+		if(instance == pooledInstances.end())
+		{
+			continue;
+		}
+		if(!IsReusable(instance->second, prefab))
+		{
+			staleRoots.push_back(root);
+			pooledInstances.erase(instance);
+			continue;
+		}
+		instance->second.inPool = false;
+		roots.push_back(root);
+		taken++;
+	}
+	entities.DestroyEntities(staleRoots);
+	return taken;
+}
+
+void PrefabSystem::ReuseInstance(const Prefab& prefab, const entt::entity* instance, const glm::vec2* position)
+{
+	auto& registry = ROSE_GETSYSTEM(EntitySystem).GetRegistry();
+	auto& transformSystem = ROSE_GETSYSTEM(TransformSystem);
+	auto& scriptSystem = ROSE_GETSYSTEM(ScriptSystem);
+	//Owners are in prefab order so parents are recalculated before their children
+	if(prefab.transforms != nullptr)
+	{
+		auto& transforms = *prefab.transforms;
+		for(int c = 0; c < transforms.owners.size(); c++)
+		{
+			auto entity = instance[transforms.owners[c]];
+			auto& trx = registry.get<TransformComponent>(entity);
+			auto& value = transforms.values[c];
+			trx.position = value.position;
+			trx.scale = value.scale;
+			trx.rotation = value.rotation;
+			if(position != nullptr && prefab.entities[transforms.owners[c]].parent < 0)
+			{
+				trx.position += *position - prefab.origin;
+			}
+			trx.UpdateGlobals();
+			transformSystem.MarkDirty(entity);
+		}
+	}
+	//Enabling moves the bodies to the new transforms, velocities left from the last use are cleared
+	ROSE_GETSYSTEM(DisableSystem).Enable(instance[0]);
+	for(int e = 0; e < prefab.entities.size(); e++)
+	{
+		auto phys = registry.try_get<PhysicsBodyComponent>(instance[e]);
+		if(phys != nullptr && phys->body != nullptr)
+		{
+			phys->body->SetLinearVelocity(b2Vec2(0, 0));
+			phys->body->SetAngularVelocity(0);
+			phys->body->SetAwake(true);
+		}
+		if(registry.any_of<ScriptComponent>(instance[e]))
+		{
+			scriptSystem.ResetScripts(instance[e]);
+		}
+	}
+}
+
+void PrefabSystem::SetPoolSize(AssetId id, int size)
+{
+	if(!id.IsValid())
+	{
+		return;
+	}
+	if(id.index >= pools.size())
+	{
+		pools.resize(id.index + 1);
+	}
+	pools[id.index].maxSize = size;
+}
+
+bool PrefabSystem::Release(entt::entity root)
+{
+	auto instance = pooledInstances.find(root);
+	if(instance == pooledInstances.end())
+	{
+		return false;
+	}
+	if(instance->second.inPool)
+	{
+		return true;
+	}
+	auto index = instance->second.prefab;
+	auto& pool = pools[index];
+	//Instances spawned before the prefab was recompiled are destroyed instead of pooled
+	bool reusable = index < prefabs.size() && prefabs[index] != nullptr && IsReusable(instance->second, *prefabs[index]);
+	if(!reusable || pool.roots.size() >= pool.maxSize)
+	{
+		pooledInstances.erase(instance);
+		return false;
+	}
+	ROSE_GETSYSTEM(DisableSystem).Disable(root);
+	pool.roots.push_back(root);
+	instance->second.inPool = true;
+	return true;
+}
+
+bool PrefabSystem::IsPooledInstance(entt::entity root) const
+{
+	auto instance = pooledInstances.find(root);
+	return instance != pooledInstances.end() && !instance->second.inPool;
+}
+
+void PrefabSystem::ClearPools()
+{
+	for(auto& pool : pools)
+	{
+		pool.roots.clear();
+	}
+	pooledInstances.clear();
+}
@@ -0,0 +1,170 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <memory>
+#include <type_traits>
+#include <unordered_map>
+
+#include <glm/glm.hpp>
+#include <entt/entt.hpp>
+
+#include "AssetPipline/Asset.h"
+
+#include "Components/TransformComponent.h"
+
+//Entity of a compiled prefab, parents always come before their children and the root is entity 0
+struct PrefabEntity
+{
+	std::string name;
+	int parent;
+};
+
+struct Prefab;
+
+class IPrefabComponents
+{
+public:
+	virtual ~IPrefabComponents() = default;
+	//entities holds instanceCount instances of the prefab back to back
+	virtual void Instantiate(entt::registry& registry, const Prefab& prefab, const std::vector<entt::entity>& entities, int instanceCount, const glm::vec2* positions) = 0;
+};
+
+//Copies of one component type, owners are indices into the prefab's entities
+template<typename TComponent>
+class PrefabComponents : public IPrefabComponents
+{
+	std::vector<entt::entity> insertEntities;
+	std::vector<TComponent> insertValues;
+
+public:
+	std::vector<int> owners;
+	std::vector<TComponent> values;
+
+	void Instantiate(entt::registry& registry, const Prefab& prefab, const std::vector<entt::entity>& entities, int instanceCount, const glm::vec2* positions) override;
+};
+
+struct Prefab
+{
+	std::vector<PrefabEntity> entities;
+	//One entry per component type in the order the level loader adds them, so transforms exist before bodies
+	std::vector<std::unique_ptr<IPrefabComponents>> components;
+	//Also in components, kept typed so pooled instances can be moved back to their spawn layout
+	PrefabComponents<TransformComponent>* transforms;
+	//Position of the root when the prefab was saved, spawn positions replace it
+	glm::vec2 origin;
+	std::uint32_t generation;
+};
+
+//Roots of disabled instances kept for reuse, their entities are found in pooledInstances
+struct PrefabPool
+{
+	int maxSize = 0;
+	//Prefab generation the pool was last swept for
+	std::uint32_t generation = 0;
+	std::vector<entt::entity> roots;
+};
+
+struct PooledInstance
+{
+	std::uint32_t prefab;
+	//Generation of the prefab the instance was spawned from, instances of older versions are never reused
+	std::uint32_t generation;
+	bool inPool;
+	//In prefab order, the root first
+	std::vector<entt::entity> entities;
+};
+
+template<typename TComponent>
+void PrefabComponents<TComponent>::Instantiate(entt::registry& registry, const Prefab& prefab, const std::vector<entt::entity>& entities, int instanceCount, const glm::vec2* positions)
+{
+	int entityCount = prefab.entities.size();
+	insertEntities.clear();
+	insertValues.clear();
+	insertEntities.reserve(owners.size() * instanceCount);
+	insertValues.reserve(owners.size() * instanceCount);
+	for(int i = 0; i < instanceCount; i++)
+	{
+		for(int c = 0; c < owners.size(); c++)
+		{
+			auto entity = entities[i * entityCount + owners[c]];
+			TComponent value = values[c];
+			if constexpr(std::is_same_v<TComponent, TransformComponent>)
+			{
+				if(positions != nullptr && prefab.entities[owners[c]].parent < 0)
+				{
+					value.position += positions[i] - prefab.origin;
+				}
+			}
+			//Hooks of earlier component types can already have added this one
+			if(registry.all_of<TComponent>(entity))
+			{
+				registry.replace<TComponent>(entity, value);
+			} else
+			{
+				insertEntities.push_back(entity);
+				insertValues.push_back(value);
+			}
+		}
+	}
+	registry.insert<TComponent>(insertEntities.begin(), insertEntities.end(), insertValues.begin());
+}
+
+class PrefabSystem
+{
+	//Indexed by AssetId index, recompiled when the asset's generation changes
+	std::vector<std::unique_ptr<Prefab>> prefabs;
+	//Indexed like prefabs
+	std::vector<PrefabPool> pools;
+	//Instances of prefabs with a pool, by root entity
+	std::unordered_map<entt::entity, PooledInstance> pooledInstances;
+
+	std::unique_ptr<Prefab> Compile(const std::string& source);
+	//Takes up to count instances out of the prefab's pool and appends their roots, they are still disabled
+	int TakePooled(AssetId id, const Prefab& prefab, int count, std::vector<entt::entity>& roots);
+	bool IsReusable(const PooledInstance& instance, const Prefab& prefab);
+	//Creates count new instances and appends their roots, reservedRoots are used as the roots when given
+	void SpawnInstances(AssetId id, const Prefab& prefab, const entt::entity* reservedRoots, const glm::vec2* positions, int count, std::vector<entt::entity>& roots);
+	void PlayQueuedSpawn(AssetId id, const std::vector<entt::entity>& roots, int reused, const std::vector<glm::vec2>& positions);
+	void ReuseInstance(const Prefab& prefab, const entt::entity* instance, const glm::vec2* position);
+	template<typename TComponent>
+	void CompileComponents(Prefab& prefab, entt::registry& staging, const std::vector<entt::entity>& stagingEntities)
+	{
+		auto components = std::make_unique<PrefabComponents<TComponent>>();
+		for(int i = 0; i < stagingEntities.size(); i++)
+		{
+			auto component = staging.try_get<TComponent>(stagingEntities[i]);
+			if(component != nullptr)
+			{
+				components->owners.push_back(i);
+				components->values.push_back(*component);
+			}
+		}
+		if(!components->owners.empty())
+		{
+			if constexpr(std::is_same_v<TComponent, TransformComponent>)
+			{
+				prefab.transforms = components.get();
+			}
+			prefab.components.push_back(std::move(components));
+		}
+	}
+
+public:
+	const Prefab* GetPrefab(AssetId id);
+	//Compiles every loaded prefab so the first spawn does not parse yaml
+	void CompileAll();
+	entt::entity Spawn(AssetId id, glm::vec2 position);
+	//Spawns one instance per position and returns their roots
+	std::vector<entt::entity> Spawn(AssetId id, const glm::vec2* positions, int count);
+	//Like Spawn but the instances are created when the entity commands are played, scripts spawn this way
+	//The returned roots are reserved right away and can be stored, they have no components until the flush
+	entt::entity QueueSpawn(AssetId id, glm::vec2 position);
+	std::vector<entt::entity> QueueSpawn(AssetId id, const glm::vec2* positions, int count);
+	//Up to size released instances of the prefab are kept disabled and reused by Spawn, 0 turns pooling off
+	void SetPoolSize(AssetId id, int size);
+	//Disables a pooled instance and returns it to its pool, false when the entity should be destroyed instead
+	bool Release(entt::entity root);
+	//True for spawned instances of pooled prefabs that are not in their pool
+	bool IsPooledInstance(entt::entity root) const;
+	void ClearPools();
+};
@@ -1,64 +1,53 @@
 #include "Physics/CollisionListener.h"
 
+#include <algorithm>
+
 #include <box2d/box2d.h>
 #include <entt/entt.hpp>
 
-#include "Core/Entity.h"
-
-#include "Events/EventBus.h"
-#include "Events/EntityEventSystem.h"
-#include "Events/PhysicsEvent.h"
-
-#include "Core/Systems.h"
-
-void ContactListener::BeginContact(b2Contact* contact)
+void ContactListener::Record(b2Contact* contact, bool begin)
 {
-	ROSE_GETSYSTEM(EventBus).EmitEvent<PhysicsEvent>(contact, true);
 	auto entityA = entt::entity(contact->GetFixtureA()->GetBody()->GetUserData().pointer);
 	auto entityB = entt::entity(contact->GetFixtureB()->GetBody()->GetUserData().pointer);
-	auto& events = ROSE_GETSYSTEM(EntityEventSystem);
-	if(contact->GetFixtureB()->IsSensor())
+	bool sensorA = contact->GetFixtureA()->IsSensor();
+	bool sensorB = contact->GetFixtureB()->IsSensor();
+	if(entityB < entityA)
 	{
-		auto entityEvent = EntityEvent(entityA, "EnteringSensor");
-		entityEvent.target = entityB;
-		events.QueueEvent(entityEvent);
-		auto entityEvent2 = EntityEvent(entityB, "SensorEntered");
-		entityEvent2.target = entityA;
-		events.QueueEvent(entityEvent2);
-	}
-	if(contact->GetFixtureA()->IsSensor())
-	{
-		auto entityEvent = EntityEvent(entityB, "EnteringSensor");
-		entityEvent.target = entityA;
-		events.QueueEvent(entityEvent);
-		auto entityEvent2 = EntityEvent(entityA, "SensorEntered");
-		entityEvent2.target = entityB;
-		events.QueueEvent(entityEvent2);
+		std::swap(entityA, entityB);
+		std::swap(sensorA, sensorB);
 	}
+	contacts.push_back({entityA, entityB, begin, sensorA, sensorB});
+}
+
+void ContactListener::BeginContact(b2Contact* contact)
+{
+	Record(contact, true);
 }
 
 void ContactListener::EndContact(b2Contact* contact)
 {
-	ROSE_GETSYSTEM(EventBus).EmitEvent<PhysicsEvent>(contact, false);
-	auto entityA = entt::entity(contact->GetFixtureA()->GetBody()->GetUserData().pointer);
-	auto entityB = entt::entity(contact->GetFixtureB()->GetBody()->GetUserData().pointer);
-	auto& events = ROSE_GETSYSTEM(EntityEventSystem);
-	if(contact->GetFixtureB()->IsSensor())
-	{
-		auto entityEvent = EntityEvent(entityA, "ExitingSensor");
-		entityEvent.target = entityB;
-		events.QueueEvent(entityEvent);
-		auto entityEvent2 = EntityEvent(entityB, "SensorExited");
-		entityEvent2.target = entityA;
-		events.QueueEvent(entityEvent2);
-	}
-	if(contact->GetFixtureA()->IsSensor())
+	Record(contact, false);
+}
+
+const std::vector<PhysicsContact>& ContactListener::Collect()
+{
+	if(contacts.size() > 1)
 	{
-		auto entityEvent = EntityEvent(entityB, "ExitingSensor");
-		entityEvent.target = entityA;
-		events.QueueEvent(entityEvent);
-		auto entityEvent2 = EntityEvent(entityA, "SensorExited");
-		entityEvent2.target = entityB;
-		events.QueueEvent(entityEvent2);
+		//Stable so a pair that began and ended in the same step still begins first
+		std::stable_sort(contacts.begin(), contacts.end(), [](const PhysicsContact& a, const PhysicsContact& b)
+			{
+				if(a.entityA != b.entityA)
+				{
+					return a.entityA < b.entityA;
+				}
+				return a.entityB < b.entityB;
+			});
+		contacts.erase(std::unique(contacts.begin(), contacts.end()), contacts.end());
 	}
+	return contacts;
+}
+
+void ContactListener::Clear()
+{
+	contacts.clear();
 }
@@ -1,7 +1,19 @@
 #pragma once
+#include <vector>
+
 #include <box2d/b2_world_callbacks.h>
 
+#include "Events/PhysicsEvent.h"
+
+//Records contacts while the world steps, nothing is dispatched from inside b2World::Step
 class ContactListener :public b2ContactListener {
+	std::vector<PhysicsContact> contacts;
+
+	void Record(b2Contact* contact, bool begin);
 	virtual void BeginContact(b2Contact* contact) override;
 	virtual void EndContact(b2Contact* contact) override;
-};
\ No newline at end of file
+public:
+	//Removes duplicate contacts and returns the recorded list, pairs keep the order their begin and end happened in
+	const std::vector<PhysicsContact>& Collect();
+	void Clear();
+};
@@ -1,18 +1,56 @@
 #include "Physics/Physics.h"
 
 #include <SDL2/SDL2_gfxPrimitives.h>
+#include <glm/gtc/constants.hpp>
 
 #include "Core/SdlContainer.h"
 #include "Core/TimeSystem.h"
+#include "Core/Transform.h"
+#include "Core/Entity.h"
 
 #include "Core/Systems.h"
 
 #include "Physics/CollisionListener.h"
 
+#include "Events/EventBus.h"
+#include "Events/EntityEventSystem.h"
+#include "Events/PhysicsEvent.h"
+
 #include "Components/DisableComponent.h"
 
 #include "Core/Log.h"
 
+static const float SYNC_EPSILON = 0.0001f;
+
+static vec2 GetBodySize(PhysicsBodyComponent& phys, TransformComponent& trx)
+{
+	auto globalScale = glm::abs(trx.globalScale);
+	if(globalScale.x < 0.01)
+	{
+		globalScale.x = 0.01;
+	}
+	if(globalScale.y < 0.01)
+	{
+		globalScale.y = 0.01;
+	}
+	return vec2(phys.size.x * globalScale.x, phys.size.y * globalScale.y);
+}
+static bool IsNear(vec2 a, vec2 b)
+{
+	return glm::all(glm::lessThan(glm::abs(a - b), vec2(SYNC_EPSILON)));
+}
+//Angles in degrees, compared around the circle
+static bool IsNearAngle(float a, float b)
+{
+	auto difference = glm::mod(glm::abs(a - b), 360.0f);
+	return glm::min(difference, 360.0f - difference) < SYNC_EPSILON;
+}
+
+//Into [-pi, pi)
+static float WrapAngle(float radians)
+{
+	return radians - glm::two_pi<float>() * glm::floor((radians + glm::pi<float>()) / glm::two_pi<float>());
+}
 
 PhysicsSystem::PhysicsSystem(float gravityX, float gravityY)
 {
@@ -22,6 +60,9 @@ PhysicsSystem::PhysicsSystem(float gravityX, float gravityY)
 	physicsWorld->SetContactListener(contactListener.get());
 	drawDebug = false;
 	debugDrawer = nullptr;
+	accumulator = 0;
+	alpha = 1;
+	deferBodies = false;
 	entt::registry& registry = ROSE_GETSYSTEM(EntitySystem).GetRegistry();
 	registry.on_construct<PhysicsBodyComponent>().connect<&PhysicsSystem::PhysicsBodyCreated>(this);
 	registry.on_destroy<PhysicsBodyComponent>().connect<&PhysicsSystem::PhysicsBodyDestroyed>(this);
@@ -47,7 +88,7 @@ void PhysicsSystem::PhysicsBodyCreated(entt::registry& registry, entt::entity en
 void PhysicsSystem::CreateEntityBody(entt::registry& registry, entt::entity entity)
 {
 	auto& phys = registry.get<PhysicsBodyComponent>(entity);
-	if(phys.body == nullptr)
+	if(phys.body == nullptr && !deferBodies)
 	{
 		auto& trx = registry.get<TransformComponent>(entity);
 		if(phys.isStatic)
@@ -63,22 +104,14 @@ void PhysicsSystem::CreateEntityBody(entt::registry& registry, entt::entity enti
 		phys.bodyDef.position.Set(trx.globalPosition.x, trx.globalPosition.y);
 
 		b2Body* body = GetWorld().CreateBody(&phys.bodyDef);
-		auto globalScale = glm::abs(trx.globalScale);
-		if(globalScale.x < 0.01)
-		{
-			globalScale.x = 0.01;
-		}
-		if(globalScale.y < 0.01)
-		{
-			globalScale.y = 0.01;
-		}
-		phys.globalSize = vec2(phys.size.x * globalScale.x, phys.size.y * globalScale.y);
+		phys.globalSize = GetBodySize(phys, trx);
 		phys.shape.SetAsBox(phys.globalSize.x / 2, phys.globalSize.y / 2);
 
 		phys.fixture.shape = &phys.shape;
 		phys.fixture.density = 1.0f;
 		phys.fixture.friction = 0.3f;
 		phys.fixture.isSensor = phys.isSensor;
+		phys.fixture.filter.categoryBits = LayerBit(phys.layer);
 		body->CreateFixture(&phys.fixture);
 		phys.body = body;
 		phys.body->GetUserData().pointer = (uintptr_t)entity;
@@ -90,8 +123,17 @@ void PhysicsSystem::CreateEntityBody(entt::registry& registry, entt::entity enti
 		{
 			phys.body->SetGravityScale(0.0f);
 		}
+		ResetSyncedPose(phys, trx);
 	}
 }
+void PhysicsSystem::ResetSyncedPose(PhysicsBodyComponent& phys, TransformComponent& trx)
+{
+	phys.syncedVersion = trx.version;
+	phys.syncedPosition = trx.globalPosition;
+	phys.syncedRotation = trx.globalRotation;
+	phys.previousPosition = vec2(phys.body->GetPosition().x, phys.body->GetPosition().y);
+	phys.previousAngle = phys.body->GetAngle();
+}
 void PhysicsSystem::PhysicsBodyDestroyed(entt::registry& registry, entt::entity entity)
 {
 	DestroyEntityBody(registry, entity);
@@ -105,56 +147,77 @@ void PhysicsSystem::DestroyEntityBody(entt::registry& registry, entt::entity ent
 		phys.body = nullptr;
 	}
 }
+//Disabled bodies stay in the world without colliding, so pooled and toggled entities do not rebuild their bodies
 void PhysicsSystem::EntityDisabled(entt::registry& registry, entt::entity entity)
 {
-	if(registry.any_of<PhysicsBodyComponent>(entity))
+	auto phys = registry.try_get<PhysicsBodyComponent>(entity);
+	if(phys != nullptr && phys->body != nullptr)
 	{
-		DestroyEntityBody(registry, entity);
+		phys->body->SetEnabled(false);
 	}
 }
 void PhysicsSystem::EntityEnabled(entt::registry& registry, entt::entity entity)
 {
-	if(registry.any_of<PhysicsBodyComponent>(entity))
+	//DisableComponent is also removed when the entity is destroyed, there is nothing to enable then
+	if(ROSE_GETSYSTEM(EntitySystem).IsDestroying() || !registry.all_of<TransformComponent, PhysicsBodyComponent>(entity))
+	{
+		return;
+	}
+	auto& phys = registry.get<PhysicsBodyComponent>(entity);
+	if(phys.body == nullptr)
 	{
 		CreateEntityBody(registry, entity);
+	} else
+	{
+		auto& trx = registry.get<TransformComponent>(entity);
+		phys.body->SetTransform(b2Vec2(trx.globalPosition.x, trx.globalPosition.y), glm::radians(trx.globalRotation));
+		phys.body->SetEnabled(true);
+		ResetSyncedPose(phys, trx);
 	}
 }
-void PhysicsSystem::CopyTransformToBody(PhysicsBodyComponent& phys, TransformComponent& trx)
+bool PhysicsSystem::CopyTransformToBody(PhysicsBodyComponent& phys, TransformComponent& trx)
 {
-	//ROSE_LOG("PosX: " + std::to_string(trx.globalPosition.x));
-	//ROSE_LOG("PosY: " + std::to_string(trx.globalPosition.y));
-	//ROSE_LOG("Rot: " + std::to_string(trx.globalRotation));
-
-	//ROSE_LOG("->PosX: " + std::to_string(phys.body->GetPosition().x));
-	//ROSE_LOG("->PosY: " + std::to_string(phys.body->GetPosition().y));
-	//ROSE_LOG("->Rot: " + std::to_string(glm::degrees(phys.body->GetAngle())));
-
-	auto globalScale = glm::abs(trx.globalScale);
-	if(globalScale.x < 0.01)
-	{
-		globalScale.x = 0.01;
-	}
-	if(globalScale.y < 0.01)
+	auto newSize = GetBodySize(phys, trx);
+	bool resized = !IsNear(phys.globalSize, newSize);
+	bool moved = !IsNear(trx.globalPosition, phys.syncedPosition) || !IsNearAngle(trx.globalRotation, phys.syncedRotation);
+	if(!resized && !moved)
 	{
-		globalScale.y = 0.01;
+		return false;
 	}
-	auto newSize = vec2(phys.size.x * globalScale.x, phys.size.y * globalScale.y);
-	if(phys.globalSize != newSize)
+	if(resized)
 	{
 		phys.body->DestroyFixture(&phys.body->GetFixtureList()[0]);
 		phys.globalSize = newSize;
 		phys.shape.SetAsBox(phys.globalSize.x / 2, phys.globalSize.y / 2);
 		phys.body->CreateFixture(&phys.fixture);
 	}
-	phys.body->SetTransform(b2Vec2(trx.globalPosition.x, trx.globalPosition.y), glm::radians(trx.globalRotation));
+	if(moved)
+	{
+		phys.body->SetTransform(b2Vec2(trx.globalPosition.x, trx.globalPosition.y), glm::radians(trx.globalRotation));
+	}
 	phys.body->SetAwake(true);
+	ResetSyncedPose(phys, trx);
+	return true;
 }
-void PhysicsSystem::CopyBodyToTransform(PhysicsBodyComponent& phys, TransformComponent& trx)
+bool PhysicsSystem::CopyBodyToTransform(entt::entity entity, PhysicsBodyComponent& phys, TransformComponent& trx)
 {
-	trx.globalPosition = glm::vec2(phys.body->GetPosition().x, phys.body->GetPosition().y);
-	trx.globalRotation = glm::degrees(phys.body->GetAngle());
+	auto bodyPosition = glm::vec2(phys.body->GetPosition().x, phys.body->GetPosition().y);
+	auto position = glm::mix(phys.previousPosition, bodyPosition, alpha);
+	//Box2D angles are unbounded and the previous angle can be reset from a wrapped rotation, so only the shortest turn is interpolated
+	auto angle = phys.previousAngle + WrapAngle(phys.body->GetAngle() - phys.previousAngle) * alpha;
+	auto rotation = glm::mod(glm::degrees(angle) + 360, 360.0f);
+	//Bodies that did not move leave their transform and its children untouched
+	if(IsNear(trx.globalPosition, position) && IsNearAngle(trx.globalRotation, rotation))
+	{
+		return false;
+	}
+	trx.globalPosition = position;
+	trx.globalRotation = rotation;
 	trx.UpdateLocals();
 	trx.UpdateGlobals();
+	phys.syncedPosition = trx.globalPosition;
+	phys.syncedRotation = trx.globalRotation;
+	ROSE_GETSYSTEM(TransformSystem).MarkDirty(entity);
 
 	//ROSE_LOG("PosX: " + std::to_string(trx.globalPosition.x));
 	//ROSE_LOG("PosY: " + std::to_string(trx.globalPosition.y));
@@ -163,6 +226,30 @@ void PhysicsSystem::CopyBodyToTransform(PhysicsBodyComponent& phys, TransformCom
 	//ROSE_LOG("->PosX: " + std::to_string(phys.body->GetPosition().x));
 	//ROSE_LOG("->PosY: " + std::to_string(phys.body->GetPosition().y));
 	//ROSE_LOG("->Rot: " + std::to_string(glm::degrees(phys.body->GetAngle())));
+	return true;
+}
+void PhysicsSystem::DeferBodies()
+{
+	deferBodies = true;
+}
+int PhysicsSystem::CreateDeferredBodies()
+{
+	deferBodies = false;
+	auto start = SDL_GetPerformanceCounter();
+	entt::registry& registry = ROSE_GETSYSTEM(EntitySystem).GetRegistry();
+	int created = 0;
+	auto view = registry.view<PhysicsBodyComponent, TransformComponent>(entt::exclude<DisableComponent>);
+	for(auto entity : view)
+	{
+		if(view.get<PhysicsBodyComponent>(entity).body == nullptr)
+		{
+			CreateEntityBody(registry, entity);
+			created++;
+		}
+	}
+	double ms = (SDL_GetPerformanceCounter() - start) * 1000.0 / SDL_GetPerformanceFrequency();
+	ROSE_LOG("Created %d physics bodies in %.2f ms", created, ms);
+	return created;
 }
 void PhysicsSystem::RemoveBody(PhysicsBodyComponent& phys)
 {
@@ -199,31 +286,229 @@ void PhysicsSystem::Update()
 	EntitySystem& entities = ROSE_GETSYSTEM(EntitySystem);
 	entt::registry& registry = entities.GetRegistry();
 	auto phView = registry.view<PhysicsBodyComponent, TransformComponent>(entt::exclude<DisableComponent>);
+	stats = PhysicsStats();
+	//Only transforms changed since the last sync are checked, so resting bodies are not woken up every frame
 	for(auto entity : phView)
 	{
 		auto& pos = phView.get<TransformComponent>(entity);
 		auto& body = phView.get<PhysicsBodyComponent>(entity);
-		CopyTransformToBody(body, pos);
+		stats.bodies++;
+		if(pos.version != body.syncedVersion)
+		{
+			if(CopyTransformToBody(body, pos))
+			{
+				stats.teleported++;
+			}
+			body.syncedVersion = pos.version;
+		}
 	}
 
 	TimeSystem& timeSystem = ROSE_GETSYSTEM(TimeSystem);
-	float timeStep = timeSystem.GetdeltaTime();
-	int velocityIterations = 10;
-	int positionIterations = 12;
-
-	physicsWorld->Step(timeStep, velocityIterations, positionIterations);
+	float timeStep = 1.0f / glm::max(settings.tickRate, 1);
+	accumulator += timeSystem.GetdeltaTime();
+	while(accumulator >= timeStep && stats.steps < settings.maxSubsteps)
+	{
+		for(auto entity : phView)
+		{
+			auto& body = phView.get<PhysicsBodyComponent>(entity);
+			if(body.body->IsAwake())
+			{
+				body.previousPosition = vec2(body.body->GetPosition().x, body.body->GetPosition().y);
+				body.previousAngle = body.body->GetAngle();
+			}
+		}
+		physicsWorld->Step(timeStep, settings.velocityIterations, settings.positionIterations);
+		DispatchContacts();
+		accumulator -= timeStep;
+		stats.steps++;
+	}
+	//Time the substep limit could not catch up on is dropped instead of piling up
+	if(accumulator > timeStep)
+	{
+		accumulator = timeStep;
+	}
+	alpha = accumulator / timeStep;
 
 	for(auto entity : phView)
 	{
-		auto& pos = phView.get<TransformComponent>(entity);
 		auto& body = phView.get<PhysicsBodyComponent>(entity);
-		CopyBodyToTransform(body, pos);
+		if(body.body->GetType() == b2_staticBody)
+		{
+			continue;
+		}
+		//Bodies that fell asleep are written once more so their transform ends on the resting pose
+		if(!body.body->IsAwake())
+		{
+			auto bodyPosition = vec2(body.body->GetPosition().x, body.body->GetPosition().y);
+			if(body.previousPosition == bodyPosition && body.previousAngle == body.body->GetAngle())
+			{
+				continue;
+			}
+			body.previousPosition = bodyPosition;
+			body.previousAngle = body.body->GetAngle();
+		}
+		auto& pos = phView.get<TransformComponent>(entity);
+		if(CopyBodyToTransform(entity, body, pos))
+		{
+			stats.synced++;
+		}
+		body.syncedVersion = pos.version;
 	}
 }
 b2World& PhysicsSystem::GetWorld()
 {
 	return *physicsWorld;
 }
+const PhysicsStats& PhysicsSystem::GetStats() const
+{
+	return stats;
+}
+void PhysicsSystem::DispatchContacts()
+{
+	auto& contacts = contactListener->Collect();
+	if(contacts.empty())
+	{
+		return;
+	}
+	stats.contacts += contacts.size();
+	ROSE_GETSYSTEM(EventBus).EmitEvent<PhysicsEvent>(contacts);
+
+	static const std::string enteringSensor = "EnteringSensor";
+	static const std::string sensorEntered = "SensorEntered";
+	static const std::string exitingSensor = "ExitingSensor";
+	static const std::string sensorExited = "SensorExited";
+	auto& events = ROSE_GETSYSTEM(EntityEventSystem);
+	for(auto& contact : contacts)
+	{
+		auto& toucherName = contact.begin ? enteringSensor : exitingSensor;
+		auto& sensorName = contact.begin ? sensorEntered : sensorExited;
+		if(contact.sensorB)
+		{
+			auto entityEvent = EntityEvent(contact.entityA, toucherName);
+			entityEvent.target = contact.entityB;
+			events.QueueEvent(entityEvent);
+			auto entityEvent2 = EntityEvent(contact.entityB, sensorName);
+			entityEvent2.target = contact.entityA;
+			events.QueueEvent(entityEvent2);
+		}
+		if(contact.sensorA)
+		{
+			auto entityEvent = EntityEvent(contact.entityB, toucherName);
+			entityEvent.target = contact.entityA;
+			events.QueueEvent(entityEvent);
+			auto entityEvent2 = EntityEvent(contact.entityA, sensorName);
+			entityEvent2.target = contact.entityB;
+			events.QueueEvent(entityEvent2);
+		}
+	}
+	contactListener->Clear();
+}
+unsigned int PhysicsSystem::LayerBit(int layer)
+{
+	return 1u << glm::clamp(layer, 0, 15);
+}
+
+//Keeps the closest non sensor fixture, returning the fraction clips the ray so farther fixtures are skipped
+class ClosestRaycast : public b2RayCastCallback
+{
+	unsigned int mask;
+public:
+	RaycastHit hit;
+	ClosestRaycast(unsigned int mask) : mask(mask)
+	{
+		hit = {NoEntity(), glm::vec2(), glm::vec2(), 1};
+	}
+	float ReportFixture(b2Fixture* fixture, const b2Vec2& point, const b2Vec2& normal, float fraction) override
+	{
+		if(fixture->IsSensor() || (fixture->GetFilterData().categoryBits & mask) == 0)
+		{
+			return -1;
+		}
+		hit.entity = entt::entity(fixture->GetBody()->GetUserData().pointer);
+		hit.point = glm::vec2(point.x, point.y);
+		hit.normal = glm::vec2(normal.x, normal.y);
+		hit.fraction = fraction;
+		return fraction;
+	}
+};
+
+//Collects fixtures whose bounds touch the query box, the caller tests their shapes
+class AABBQuery : public b2QueryCallback
+{
+	unsigned int mask;
+public:
+	std::vector<b2Fixture*>& fixtures;
+	AABBQuery(unsigned int mask, std::vector<b2Fixture*>& fixtures) : mask(mask), fixtures(fixtures)
+	{
+	}
+	bool ReportFixture(b2Fixture* fixture) override
+	{
+		if((fixture->GetFilterData().categoryBits & mask) != 0)
+		{
+			fixtures.push_back(fixture);
+		}
+		return true;
+	}
+};
+
+RaycastHit PhysicsSystem::Raycast(glm::vec2 from, glm::vec2 to, unsigned int mask)
+{
+	ClosestRaycast callback(mask);
+	//Box2D asserts on zero length rays
+	if(from != to)
+	{
+		physicsWorld->RayCast(&callback, b2Vec2(from.x, from.y), b2Vec2(to.x, to.y));
+	}
+	return callback.hit;
+}
+void PhysicsSystem::Raycast(const Ray* rays, int count, RaycastHit* hits, unsigned int mask)
+{
+	for(int i = 0; i < count; i++)
+	{
+		hits[i] = Raycast(rays[i].from, rays[i].to, mask);
+	}
+}
+int PhysicsSystem::Overlap(const b2Shape& shape, const b2Transform& transform, std::vector<entt::entity>& result, unsigned int mask)
+{
+	queryFixtures.clear();
+	b2AABB bounds;
+	shape.ComputeAABB(&bounds, transform, 0);
+	AABBQuery query(mask, queryFixtures);
+	physicsWorld->QueryAABB(&query, bounds);
+	int found = 0;
+	for(auto fixture : queryFixtures)
+	{
+		if(b2TestOverlap(&shape, 0, fixture->GetShape(), 0, transform, fixture->GetBody()->GetTransform()))
+		{
+			result.push_back(entt::entity(fixture->GetBody()->GetUserData().pointer));
+			found++;
+		}
+	}
+	return found;
+}
+int PhysicsSystem::OverlapBox(glm::vec2 center, glm::vec2 size, float rotation, std::vector<entt::entity>& result, unsigned int mask)
+{
+	b2PolygonShape box;
+	box.SetAsBox(glm::max(size.x / 2, b2_linearSlop), glm::max(size.y / 2, b2_linearSlop));
+	return Overlap(box, b2Transform(b2Vec2(center.x, center.y), b2Rot(glm::radians(rotation))), result, mask);
+}
+int PhysicsSystem::OverlapCircle(glm::vec2 center, float radius, std::vector<entt::entity>& result, unsigned int mask)
+{
+	b2CircleShape circle;
+	circle.m_radius = radius;
+	b2Transform transform;
+	transform.Set(b2Vec2(center.x, center.y), 0);
+	return Overlap(circle, transform, result, mask);
+}
+void PhysicsSystem::SetSettings(const PhysicsSettings& settings)
+{
+	this->settings = settings;
+	accumulator = 0;
+}
+const PhysicsSettings& PhysicsSystem::GetSettings() const
+{
+	return settings;
+}
 
 void PhysicsSystem::InitDebugDrawer()
 {
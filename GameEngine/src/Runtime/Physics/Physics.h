@@ -1,11 +1,16 @@
 #pragma once
 #include <memory>
+#include <vector>
 
 #include <box2d/box2d.h>
 #include <entt/entt.hpp>
 #include <glm/glm.hpp>
 #include <SDL2/SDL.h>
 
+#include "Project/Project.h"
+
+#include "Physics/CollisionListener.h"
+
 #include "Components/PhysicsBodyComponent.h"
 #include "Components/TransformComponent.h"
 
@@ -26,27 +31,86 @@ public:
 };
 
 
+struct PhysicsStats
+{
+	int bodies = 0;
+	//Bodies moved to their transform before the step
+	int teleported = 0;
+	//Transforms written back from awake bodies after the step
+	int synced = 0;
+	//Fixed steps taken this frame
+	int steps = 0;
+	//Contacts dispatched this frame after duplicates were removed
+	int contacts = 0;
+};
+
+struct RaycastHit
+{
+	//NoEntity when the ray hit nothing
+	entt::entity entity;
+	glm::vec2 point;
+	glm::vec2 normal;
+	//Distance along the ray from 0 at its start to 1 at its end
+	float fraction;
+};
+
+struct Ray
+{
+	glm::vec2 from;
+	glm::vec2 to;
+};
+
 class PhysicsSystem
 {
 	DebugDraw* debugDrawer;
 	bool drawDebug;
+	PhysicsStats stats;
+	PhysicsSettings settings;
+	float accumulator;
+	//How far the frame is between the last two fixed steps, transforms are interpolated by it
+	float alpha;
+	//Set while a level loads, bodies are created once the level's transforms are known
+	bool deferBodies;
 	std::unique_ptr<b2World> physicsWorld;
-	std::unique_ptr<b2ContactListener> contactListener;
+	std::unique_ptr<ContactListener> contactListener;
+	//Scratch buffer of overlap queries
+	std::vector<b2Fixture*> queryFixtures;
 	void PhysicsBodyCreated(entt::registry& registry, entt::entity entity);
 	void CreateEntityBody(entt::registry& registry, entt::entity entity);
 	void PhysicsBodyDestroyed(entt::registry& registry, entt::entity entity);
 	void DestroyEntityBody(entt::registry& registry, entt::entity entity);
 	void EntityDisabled(entt::registry& registry, entt::entity entity);
 	void EntityEnabled(entt::registry& registry, entt::entity entity);
+	void ResetSyncedPose(PhysicsBodyComponent& phys, TransformComponent& trx);
+	void DispatchContacts();
+	int Overlap(const b2Shape& shape, const b2Transform& transform, std::vector<entt::entity>& result, unsigned int mask);
 public:
 	PhysicsSystem(float gravityX, float gravityY);
 	~PhysicsSystem();
-	void CopyTransformToBody(PhysicsBodyComponent& phys, TransformComponent& trx);
-	void CopyBodyToTransform(PhysicsBodyComponent& phys, TransformComponent& trx);
+	//Both return whether anything was copied, poses that already match are left alone
+	bool CopyTransformToBody(PhysicsBodyComponent& phys, TransformComponent& trx);
+	bool CopyBodyToTransform(entt::entity entity, PhysicsBodyComponent& phys, TransformComponent& trx);
 	void RemoveBody(PhysicsBodyComponent& phys);
 	void AddBody(entt::entity entity, PhysicsBodyComponent& phys);
 	void Update();
 	b2World& GetWorld();
+	const PhysicsStats& GetStats() const;
+	//Body components added after this keep a null body until CreateDeferredBodies
+	void DeferBodies();
+	//Creates the bodies of every enabled entity that has none and returns how many were created
+	int CreateDeferredBodies();
+	static constexpr unsigned int AllLayers = 0xFFFF;
+	static unsigned int LayerBit(int layer);
+	//Closest body along the segment whose layer is in mask, sensors are not hit so they do not block sight
+	RaycastHit Raycast(glm::vec2 from, glm::vec2 to, unsigned int mask = AllLayers);
+	//Casts every ray and writes one hit per ray into hits
+	void Raycast(const Ray* rays, int count, RaycastHit* hits, unsigned int mask = AllLayers);
+	//Appends the entities whose body overlaps the shape to result and returns how many were found, sensors included
+	int OverlapBox(glm::vec2 center, glm::vec2 size, float rotation, std::vector<entt::entity>& result, unsigned int mask = AllLayers);
+	int OverlapCircle(glm::vec2 center, float radius, std::vector<entt::entity>& result, unsigned int mask = AllLayers);
+	//Applied when a level is loaded, resets the step accumulator
+	void SetSettings(const PhysicsSettings& settings);
+	const PhysicsSettings& GetSettings() const;
 
 	void InitDebugDrawer();
 	void EnableDebug(bool enable);
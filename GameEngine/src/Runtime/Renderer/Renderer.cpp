@@ -1,10 +1,14 @@
 #include "Renderer/Renderer.h"
 
 #include <entt/entity/registry.hpp>
+#include <entt/core/algorithm.hpp>
+
+#include <algorithm>
 
 #include "Core/SdlContainer.h"
 #include "AssetPipline/AssetStore.h"
 #include "Core/Systems.h"
+#include "Core/JobSystem.h"
 
 #include "Components/TransformComponent.h"
 #include "Components/SpriteComponent.h"
@@ -14,12 +18,86 @@
 
 #include "Core/Log.h"
 
+const int MAX_INSERTION_SORT_CHANGES = 8;
+const int VERTEX_CHUNK_SIZE = 512;
+//One packet being gathered and built while the other is submitted
+const int FRAME_PACKET_COUNT = 2;
+
+static Bounds GetBounds(const vec2* corners, int count)
+{
+	Bounds bounds = {corners[0], corners[0]};
+	for(int i = 1; i < count; i++)
+	{
+		bounds.min = glm::min(bounds.min, corners[i]);
+		bounds.max = glm::max(bounds.max, corners[i]);
+	}
+	return bounds;
+}
+
+static Bounds GetSpriteBounds(const Affine& matrix, vec2 extents)
+{
+	vec2 corners[] = {
+		matrix.Apply({-extents.x,extents.y}),
+		matrix.Apply({extents.x,extents.y}),
+		matrix.Apply({extents.x,-extents.y}),
+		matrix.Apply({-extents.x,-extents.y}),
+	};
+	return GetBounds(corners, 4);
+}
+
+static Bounds GetScreenBounds(const glm::mat3& screenToWorld, vec2 screenSize)
+{
+	vec2 corners[] = {
+		TransformComponent::GetPosition(screenToWorld, {0,0}),
+		TransformComponent::GetPosition(screenToWorld, {screenSize.x,0}),
+		TransformComponent::GetPosition(screenToWorld, {screenSize.x,screenSize.y}),
+		TransformComponent::GetPosition(screenToWorld, {0,screenSize.y}),
+	};
+	return GetBounds(corners, 4);
+}
+
+//Sets everything but the vertex positions, those are written when the packet is built
+static void GatherSpriteQuad(const SpriteComponent& sp, const SpriteProxy& proxy, SpriteQuad& quad)
+{
+	SDL_Color color = {sp.color.r * 255, sp.color.g * 255, sp.color.b * 255, sp.color.a * 255};
+	quad.layer = sp.layer;
+	quad.textureKey = proxy.texture->sortKey;
+	quad.texture = proxy.texture->texture;
+	quad.blendMode = SDL_BLENDMODE_BLEND;
+	for(int v = 0; v < 4; v++)
+	{
+		quad.vertices[v] = {{0,0}, color, proxy.uvs[v]};
+	}
+}
+
 RendererSystem::RendererSystem()
 {
 	SdlContainer& sdlRenderer = ROSE_GETSYSTEM(SdlContainer);
 	this->sdlRenderer = sdlRenderer.GetRenderer();
 	camera = NoEntity();
 	this->worldToScreenMatrix = glm::mat3(1);
+	framePackets.resize(FRAME_PACKET_COUNT);
+	for(auto& packet : framePackets)
+	{
+		packet.batch = SpriteBatch(this->sdlRenderer);
+	}
+	pipelined = false;
+	stopBuildThread = false;
+	buildPacket = -1;
+	gatherPacket = 0;
+	submitPacket = -1;
+	outputSize = {0,0};
+	pendingLayerChanges = 0;
+	parallelVertexGeneration = true;
+
+	entt::registry& registry = ROSE_GETSYSTEM(EntitySystem).GetRegistry();
+	registry.on_construct<SpriteComponent>().connect<&RendererSystem::SpriteOrderChanged>(this);
+	registry.on_update<SpriteComponent>().connect<&RendererSystem::SpriteChanged>(this);
+	registry.on_update<SpriteComponent>().connect<&RendererSystem::SpriteOrderChanged>(this);
+	registry.on_destroy<SpriteComponent>().connect<&RendererSystem::SpriteOrderChanged>(this);
+	registry.on_destroy<SpriteComponent>().connect<&RendererSystem::SpriteDestroyed>(this);
+	registry.on_update<SpriteComponent>().connect<&RendererSystem::StaticSpriteChanged>(this);
+	registry.on_construct<DisableComponent>().connect<&RendererSystem::StaticSpriteChanged>(this);
 #ifdef _EDITOR
 	editorViewHeight = 10;
 	editorViewPos = {0,0};
@@ -27,18 +105,186 @@ RendererSystem::RendererSystem()
 }
 RendererSystem::~RendererSystem()
 {
+	SetPipelinedRendering(false);
 }
-void RendererSystem::Render()
+void RendererSystem::SpriteOrderChanged(entt::registry& registry, entt::entity entity)
 {
-	EntitySystem& entities = entt::locator<EntitySystem>::value();
-	entt::registry& registry = entities.GetRegistry();
-	AssetStore& assetStore = entt::locator<AssetStore>::value();
-	SDL_SetRenderDrawColor(sdlRenderer, 94, 35, 35, SDL_ALPHA_OPAQUE);
-	SDL_RenderClear(sdlRenderer);
-	registry.sort<SpriteComponent>([](const auto& lhs, const auto& rhs)
+	pendingLayerChanges++;
+}
+void RendererSystem::SpriteChanged(entt::registry& registry, entt::entity entity)
+{
+	auto& sp = registry.get<SpriteComponent>(entity);
+	sp.spriteId = ROSE_GETSYSTEM(AssetStore).GetAssetId(sp.sprite);
+}
+void RendererSystem::SpriteDestroyed(entt::registry& registry, entt::entity entity)
+{
+	spriteGrid.Remove(entity);
+	StaticSpriteChanged(registry, entity);
+	auto index = entt::to_entity(entity);
+	if(index < spriteProxies.size())
+	{
+		spriteProxies[index].valid = false;
+	}
+}
+void RendererSystem::StaticSpriteChanged(entt::registry& registry, entt::entity entity)
+{
+	if(staticSprites.Contains(entity))
+	{
+		staticSprites.Invalidate();
+	}
+}
+bool RendererSystem::UpdateSpriteProxy(SpriteProxy& proxy, const SpriteComponent& sp, const AssetStore& assetStore)
+{
+	bool hasSourceRect = sp.sourceRect != nullptr;
+	AssetId asset = assetStore.GetCurrentId(sp.spriteId);
+	if(proxy.valid && proxy.asset == asset && proxy.hasSourceRect == hasSourceRect)
+	{
+		if(!hasSourceRect)
 		{
-			return lhs.layer < rhs.layer;
+			return false;
+		}
+		const SDL_Rect& rect = *sp.sourceRect;
+		if(proxy.sourceRect.x == rect.x && proxy.sourceRect.y == rect.y && proxy.sourceRect.w == rect.w && proxy.sourceRect.h == rect.h)
+		{
+			return false;
+		}
+	}
+	proxy.valid = true;
+	proxy.asset = asset;
+	proxy.hasSourceRect = hasSourceRect;
+	proxy.sourceRect = hasSourceRect ? *sp.sourceRect : DEFAULT_RECT;
+	proxy.texture = nullptr;
+
+	auto spriteHandle = assetStore.GetAsset(asset);
+	auto texture = static_cast<TextureAsset*>(spriteHandle.asset);
+	if(spriteHandle.type != AssetType::Texture || texture == nullptr || texture->width == 0 || texture->height == 0)
+	{
+		return true;
+	}
+	proxy.texture = texture;
+	//Source rects are relative to the texture asset, which may be a region of an atlas page
+	vec2 pageSize = vec2(texture->pageWidth, texture->pageHeight);
+	vec2 offset = vec2(texture->region.x, texture->region.y);
+	vec2 size = vec2(texture->width, texture->height);
+	if(hasSourceRect)
+	{
+		offset += vec2(proxy.sourceRect.x, proxy.sourceRect.y);
+		size = vec2(proxy.sourceRect.w, proxy.sourceRect.h);
+	}
+	vec2 uvPos = offset / pageSize;
+	vec2 uvSize = size / pageSize;
+	proxy.extents = size / (float)texture->ppu / 2.0f;
+	proxy.uvs[0] = {uvPos.x,uvPos.y};
+	proxy.uvs[1] = {uvPos.x + uvSize.x,uvPos.y};
+	proxy.uvs[2] = {uvPos.x + uvSize.x,uvPos.y + uvSize.y};
+	proxy.uvs[3] = {uvPos.x,uvPos.y + uvSize.y};
+	return true;
+}
+void RendererSystem::UpdateSpriteProxies(entt::registry& registry)
+{
+	const AssetStore& assetStore = ROSE_GETSYSTEM(AssetStore);
+	auto view = registry.view<const SpriteComponent, const TransformComponent>(entt::exclude<DisableComponent>);
+	for(auto entity : view)
+	{
+		const auto& trx = view.get<const TransformComponent>(entity);
+		const auto& sp = view.get<const SpriteComponent>(entity);
+		auto index = entt::to_entity(entity);
+		if(index >= spriteProxies.size())
+		{
+			spriteProxies.resize(index + 1);
+		}
+		auto& proxy = spriteProxies[index];
+		bool proxyChanged = UpdateSpriteProxy(proxy, sp, assetStore);
+		if(sp.isStatic)
+		{
+			bool missing = proxy.texture != nullptr && !staticSprites.Contains(entity);
+			if(proxyChanged || missing || proxy.transformVersion != trx.version)
+			{
+				proxy.transformVersion = trx.version;
+				staticSprites.Invalidate();
+				spriteGrid.Remove(entity);
+			}
+			continue;
+		}
+		if(staticSprites.Contains(entity))
+		{
+			staticSprites.Invalidate();
+		}
+		if(!proxyChanged && proxy.transformVersion == trx.version)
+		{
+			continue;
+		}
+		proxy.transformVersion = trx.version;
+		if(proxy.texture == nullptr)
+		{
+			spriteGrid.Remove(entity);
+			continue;
+		}
+		spriteGrid.Update(entity, GetSpriteBounds(trx.matrixL2W, proxy.extents));
+	}
+}
+void RendererSystem::RebuildStaticSprites(entt::registry& registry)
+{
+	staticSprites.Clear();
+	auto view = registry.view<const SpriteComponent, const TransformComponent>(entt::exclude<DisableComponent>);
+	for(auto entity : view)
+	{
+		const auto& sp = view.get<const SpriteComponent>(entity);
+		if(!sp.isStatic)
+		{
+			continue;
+		}
+		const auto& proxy = spriteProxies[entt::to_entity(entity)];
+		if(proxy.texture == nullptr)
+		{
+			continue;
+		}
+		SDL_Color color = {sp.color.r * 255, sp.color.g * 255, sp.color.b * 255, sp.color.a * 255};
+		staticSprites.Add(entity, sp.layer, proxy.texture->sortKey, proxy.texture->texture, view.get<const TransformComponent>(entity).matrixL2W, proxy.extents, proxy.uvs, color);
+	}
+	staticSprites.Build();
+}
+void RendererSystem::CollectVisibleSprites(entt::registry& registry, const Bounds& cameraBounds)
+{
+	visibleSprites.clear();
+	spriteGrid.Query(cameraBounds, visibleSprites);
+	auto& disabled = registry.storage<DisableComponent>();
+	visibleSprites.erase(std::remove_if(visibleSprites.begin(), visibleSprites.end(), [&disabled](entt::entity entity)
+		{
+			return disabled.contains(entity);
+		}), visibleSprites.end());
+	auto& sprites = registry.storage<SpriteComponent>();
+	std::sort(visibleSprites.begin(), visibleSprites.end(), [&sprites](entt::entity lhs, entt::entity rhs)
+		{
+			return sprites.index(lhs) < sprites.index(rhs);
 		});
+}
+void RendererSystem::UpdateDrawOrder(entt::registry& registry)
+{
+	if(pendingLayerChanges == 0)
+	{
+		return;
+	}
+	auto compare = [](const SpriteComponent& lhs, const SpriteComponent& rhs)
+		{
+			return lhs.layer < rhs.layer;
+		};
+	if(pendingLayerChanges <= MAX_INSERTION_SORT_CHANGES)
+	{
+		registry.sort<SpriteComponent>(compare, entt::insertion_sort{});
+	} else
+	{
+		registry.sort<SpriteComponent>(compare);
+	}
+	pendingLayerChanges = 0;
+}
+void RendererSystem::Extract(FramePacket& packet)
+{
+	EntitySystem& entities = entt::locator<EntitySystem>::value();
+	entt::registry& registry = entities.GetRegistry();
+	packet.batch.Begin();
+	packet.quadCount = 0;
+	UpdateDrawOrder(registry);
 	TransformComponent* camPos = nullptr;
 	float camHeight = 10;
 	if(registry.valid(camera))
@@ -98,10 +344,8 @@ void RendererSystem::Render()
 		auto& parentPos = registry.get<TransformComponent>(camPos->parent.value());
 		camToWorldMatrix = camToWorldMatrix;
 	}*/
-	auto worldToCamMatrix = glm::inverse(camToWorldMatrix);
-	int windowSizeX, windowSizeY;
-	SDL_GetRendererOutputSize(sdlRenderer, &windowSizeX, &windowSizeY);
-	auto windowSize = glm::vec2(windowSizeX, windowSizeY);
+	auto worldToCamMatrix = Affine(camToWorldMatrix).Inverse().ToMat3();
+	auto windowSize = glm::vec2(GetOutputSize());
 	float windowAspectRatio = windowSize.x / windowSize.y;
 	float camWidth = windowAspectRatio * camHeight;
 	float camToScreenScaleX = windowSize.x / (camWidth);
@@ -122,84 +366,174 @@ void RendererSystem::Render()
 
 
 
-	auto view2 = registry.view<SpriteComponent, const TransformComponent>(entt::exclude<DisableComponent>).use<SpriteComponent>();
-	for(auto entity : view2)
+	UpdateSpriteProxies(registry);
+	if(staticSprites.IsDirty())
 	{
-		int x = view2.size_hint();
-		const auto& pos = view2.get<TransformComponent>(entity);
-		auto& sp = view2.get<SpriteComponent>(entity);
-		auto spriteHandle = assetStore.GetAsset(sp.sprite);
-		if(spriteHandle.type != AssetType::Texture)
+		RebuildStaticSprites(registry);
+	}
+	auto cameraBounds = GetScreenBounds(GetScreenToWorldMatrix(), windowSize);
+	CollectVisibleSprites(registry, cameraBounds);
+
+	staticSprites.Submit(packet.batch, worldToScreenMatrix, cameraBounds);
+	auto& transforms = registry.storage<TransformComponent>();
+	auto& sprites = registry.storage<SpriteComponent>();
+	int count = visibleSprites.size();
+	packet.quads = packet.batch.Allocate(count);
+	packet.quadCount = count;
+	packet.screenTransform = Affine(worldToScreenMatrix);
+	packet.transforms.resize(count);
+	packet.extents.resize(count);
+	packet.corners.resize(count * 8);
+	//Everything the build reads is copied here, so the registry can change while the packet is built
+	auto gather = [&](int begin, int end)
 		{
-			continue;
-		}
-		auto texture = static_cast<TextureAsset*>(spriteHandle.asset);
-		if(texture == nullptr)
+			for(int i = begin; i < end; i++)
+			{
+				auto entity = visibleSprites[i];
+				auto& proxy = spriteProxies[entt::to_entity(entity)];
+				packet.transforms[i] = transforms.get(entity).matrixL2W;
+				packet.extents[i] = proxy.extents;
+				GatherSpriteQuad(sprites.get(entity), proxy, packet.quads[i]);
+			}
+		};
+	if(parallelVertexGeneration)
+	{
+		ROSE_GETSYSTEM(JobSystem).ParallelFor(count, VERTEX_CHUNK_SIZE, gather);
+	} else
+	{
+		gather(0, count);
+	}
+}
+void RendererSystem::BuildVertices(FramePacket& packet, bool parallel)
+{
+	auto build = [&packet](int begin, int end)
 		{
-			continue;
-		}
-		int texW, texH;
-		SDL_Rect* sourceRect = sp.sourceRect;
-		if(sourceRect != nullptr)
+			ComposeAffines(packet.transforms.data() + begin, packet.screenTransform, packet.transforms.data() + begin, end - begin);
+			TransformQuads(packet.transforms.data() + begin, packet.extents.data() + begin, packet.corners.data() + begin * 8, end - begin);
+			for(int i = begin; i < end; i++)
+			{
+				auto& quad = packet.quads[i];
+				for(int v = 0; v < 4; v++)
+				{
+					quad.vertices[v].position = {packet.corners[i * 8 + v * 2], packet.corners[i * 8 + v * 2 + 1]};
+				}
+			}
+		};
+	if(parallel)
+	{
+		ROSE_GETSYSTEM(JobSystem).ParallelFor(packet.quadCount, VERTEX_CHUNK_SIZE, build);
+	} else
+	{
+		build(0, packet.quadCount);
+	}
+	packet.batch.Prepare();
+}
+void RendererSystem::Submit(FramePacket& packet)
+{
+	SDL_SetRenderDrawColor(sdlRenderer, 94, 35, 35, SDL_ALPHA_OPAQUE);
+	SDL_RenderClear(sdlRenderer);
+	packet.batch.End();
+	lastStats = packet.batch.GetStats();
+}
+void RendererSystem::Render()
+{
+	if(!pipelined)
+	{
+		Extract(framePackets[0]);
+		BuildVertices(framePackets[0], parallelVertexGeneration);
+		Submit(framePackets[0]);
+		return;
+	}
+	//The build thread can still be working on the other packet while this one is gathered
+	Extract(framePackets[gatherPacket]);
+	WaitForBuild();
+	int previous = submitPacket;
+	{
+		std::lock_guard<std::mutex> lock(buildMutex);
+		buildPacket = gatherPacket;
+	}
+	buildReady.notify_one();
+	if(previous >= 0)
+	{
+		Submit(framePackets[previous]);
+	} else
+	{
+		SDL_SetRenderDrawColor(sdlRenderer, 94, 35, 35, SDL_ALPHA_OPAQUE);
+		SDL_RenderClear(sdlRenderer);
+	}
+	submitPacket = gatherPacket;
+	gatherPacket = (gatherPacket + 1) % FRAME_PACKET_COUNT;
+}
+void RendererSystem::WaitForBuild()
+{
+	std::unique_lock<std::mutex> lock(buildMutex);
+	buildDone.wait(lock, [this]()
 		{
-			texH = sourceRect->h;
-			texW = sourceRect->w;
-		} else
+			return buildPacket < 0;
+		});
+}
+void RendererSystem::BuildThreadLoop()
+{
+	while(true)
+	{
+		int packet;
 		{
-			SDL_QueryTexture(texture->texture, nullptr, nullptr, &texW, &texH);
+			std::unique_lock<std::mutex> lock(buildMutex);
+			buildReady.wait(lock, [this]()
+				{
+					return stopBuildThread || buildPacket >= 0;
+				});
+			if(buildPacket < 0)
+			{
+				return;
+			}
+			packet = buildPacket;
 		}
-		auto viewMatrix = pos.matrixL2W * worldToScreenMatrix;
-
-		SDL_SetTextureBlendMode(texture->texture, SDL_BLENDMODE_BLEND);
-
-		vec2 spriteExtents = vec2(texW, texH) / (float)texture->ppu / 2.0f;
-		vec2 v1 = TransformComponent::GetPosition(viewMatrix, {-spriteExtents.x,spriteExtents.y});
-		vec2 v2 = TransformComponent::GetPosition(viewMatrix, {spriteExtents.x,spriteExtents.y});
-		vec2 v3 = TransformComponent::GetPosition(viewMatrix, {spriteExtents.x,-spriteExtents.y});
-		vec2 v4 = TransformComponent::GetPosition(viewMatrix, {-spriteExtents.x,-spriteExtents.y});
-
-
-		SDL_Color color = {sp.color.r * 255, sp.color.g * 255, sp.color.b * 255, sp.color.a * 255};
-		SDL_Vertex vertex_1 = {{v1.x,v1.y}, color, {0, 0}};
-		SDL_Vertex vertex_2 = {{v2.x,v2.y}, color, {1, 0}};
-		SDL_Vertex vertex_3 = {{v3.x,v3.y}, color, {1, 1}};
-		SDL_Vertex vertex_4 = {{v4.x,v4.y}, color, {0, 1}};
-
-		if(sp.sourceRect != nullptr)
-		{
-			int texW;
-			int texH;
-			SDL_QueryTexture(texture->texture, nullptr, nullptr, &texW, &texH);
-			vec2 pos = {sp.sourceRect->x,sp.sourceRect->y};
-			vec2 size = {sp.sourceRect->w,sp.sourceRect->h};
-			pos.x /= texW;
-			pos.y /= texH;
-			size.x /= texW;
-			size.y /= texH;
-			vertex_1.tex_coord = {pos.x,pos.y};
-			vertex_2.tex_coord = {pos.x + size.x,pos.y};
-			vertex_3.tex_coord = {pos.x + size.x,pos.y + size.y};
-			vertex_4.tex_coord = {pos.x,pos.y + size.y};
+		//The job system is driven from the main thread, so the build runs on this thread alone
+		BuildVertices(framePackets[packet], false);
+		{
+			std::lock_guard<std::mutex> lock(buildMutex);
+			buildPacket = -1;
 		}
-		SDL_Vertex vertices[] = {
-			vertex_1,
-			vertex_2,
-			vertex_3,
-			vertex_4,
-		};
-
-		int indecies[] = {
-			0,
-			1,
-			2,
-			0,
-			2,
-			3
-		};
-
-		SDL_RenderGeometry(sdlRenderer, texture->texture, vertices, 4, indecies, 6);
+		buildDone.notify_one();
 	}
 }
+void RendererSystem::SetPipelinedRendering(bool enabled)
+{
+	if(enabled == pipelined)
+	{
+		return;
+	}
+	if(enabled)
+	{
+		buildPacket = -1;
+		gatherPacket = 0;
+		submitPacket = -1;
+		stopBuildThread = false;
+		pipelined = true;
+		buildThread = std::thread(&RendererSystem::BuildThreadLoop, this);
+	} else
+	{
+		WaitForBuild();
+		{
+			std::lock_guard<std::mutex> lock(buildMutex);
+			stopBuildThread = true;
+		}
+		buildReady.notify_one();
+		buildThread.join();
+		pipelined = false;
+	}
+}
+bool RendererSystem::IsPipelinedRendering() const
+{
+	return pipelined;
+}
+glm::ivec2 RendererSystem::GetOutputSize()
+{
+	SDL_GetRendererOutputSize(sdlRenderer, &outputSize.x, &outputSize.y);
+	return outputSize;
+}
+
 void RendererSystem::Present()
 {
 	SDL_RenderPresent(sdlRenderer);
@@ -218,7 +552,7 @@ const glm::mat3 RendererSystem::GetWorldToScreenMatrix() const
 }
 const glm::mat3 RendererSystem::GetScreenToWorldMatrix() const
 {
-	return glm::inverse(worldToScreenMatrix);
+	return Affine(worldToScreenMatrix).Inverse().ToMat3();
 }
 void RendererSystem::InitLoaded()
 {
@@ -245,3 +579,18 @@ float RendererSystem::GetAspectRatio()
 {
 	return aspectRatio;
 }
+
+BatchStats RendererSystem::GetBatchStats()
+{
+	return lastStats;
+}
+
+void RendererSystem::SetParallelVertexGeneration(bool enabled)
+{
+	parallelVertexGeneration = enabled;
+}
+
+bool RendererSystem::IsParallelVertexGeneration() const
+{
+	return parallelVertexGeneration;
+}
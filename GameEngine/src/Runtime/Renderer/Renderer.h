@@ -1,14 +1,93 @@
 #pragma once
 #include <SDL2/SDL.h>
 #include <entt/entity/entity.hpp>
+#include <entt/entity/registry.hpp>
 #include <glm/glm.hpp>
 
+#include <vector>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "Renderer/SpriteBatch.h"
+#include "Renderer/SpatialGrid.h"
+#include "Renderer/StaticSpriteCache.h"
+#include "AssetPipline/TextureAsset.h"
+#include "Core/Affine.h"
+
+class AssetStore;
+class SpriteComponent;
+
+//Resolved render data for a sprite, rebuilt only when the sprite, its source rect or the asset store changes
+struct SpriteProxy
+{
+	TextureAsset* texture = nullptr;
+	AssetId asset;
+	SDL_Rect sourceRect = {};
+	bool hasSourceRect = false;
+	glm::vec2 extents = {};
+	SDL_FPoint uvs[4] = {};
+	unsigned int transformVersion = 0;
+	bool valid = false;
+};
+
+//One frame of sprites, gathered on the main thread and then only read while its vertices are built
+struct FramePacket
+{
+	SpriteBatch batch;
+	//Quads allocated in the batch, their attributes are set when gathered and their positions when built
+	SpriteQuad* quads = nullptr;
+	int quadCount = 0;
+	Affine screenTransform;
+	std::vector<Affine> transforms;
+	std::vector<glm::vec2> extents;
+	std::vector<float> corners;
+};
+
 class RendererSystem
 {
 	SDL_Renderer* sdlRenderer;
 	entt::entity camera;
 	glm::mat3 worldToScreenMatrix;
 	float aspectRatio;
+	std::vector<FramePacket> framePackets;
+	BatchStats lastStats;
+	glm::ivec2 outputSize;
+	bool pipelined;
+	//Builds the vertices of one packet while the main thread submits the previous one
+	std::thread buildThread;
+	std::mutex buildMutex;
+	std::condition_variable buildReady;
+	std::condition_variable buildDone;
+	//Packet handed to the build thread, -1 when it is idle
+	int buildPacket;
+	bool stopBuildThread;
+	int gatherPacket;
+	//Packet waiting to be submitted next frame, -1 when there is none
+	int submitPacket;
+	int pendingLayerChanges;
+	SpatialGrid spriteGrid;
+	std::vector<SpriteProxy> spriteProxies;
+	std::vector<entt::entity> visibleSprites;
+	StaticSpriteCache staticSprites;
+	bool parallelVertexGeneration;
+
+	void SpriteOrderChanged(entt::registry& registry, entt::entity entity);
+	void SpriteChanged(entt::registry& registry, entt::entity entity);
+	void SpriteDestroyed(entt::registry& registry, entt::entity entity);
+	void StaticSpriteChanged(entt::registry& registry, entt::entity entity);
+	void UpdateDrawOrder(entt::registry& registry);
+	bool UpdateSpriteProxy(SpriteProxy& proxy, const SpriteComponent& sprite, const AssetStore& assetStore);
+	void UpdateSpriteProxies(entt::registry& registry);
+	void RebuildStaticSprites(entt::registry& registry);
+	void CollectVisibleSprites(entt::registry& registry, const Bounds& cameraBounds);
+	void Extract(FramePacket& packet);
+	void BuildVertices(FramePacket& packet, bool parallel);
+	void Submit(FramePacket& packet);
+	void BuildThreadLoop();
+	void WaitForBuild();
+	glm::ivec2 GetOutputSize();
 public:
 	glm::vec2 editorViewPos;
 	float editorViewHeight;
@@ -22,4 +101,11 @@ public:
 	const glm::mat3 GetScreenToWorldMatrix() const;
 	void InitLoaded();
 	float GetAspectRatio();
+	BatchStats GetBatchStats();
+	//Builds a frame's vertices on a worker thread while the previous frame is submitted, frames are shown one frame later.
+	//All SDL calls stay on the calling thread
+	void SetPipelinedRendering(bool enabled);
+	bool IsPipelinedRendering() const;
+	void SetParallelVertexGeneration(bool enabled);
+	bool IsParallelVertexGeneration() const;
 };
\ No newline at end of file
@@ -0,0 +1,153 @@
+#include "Renderer/SpatialGrid.h"
+
+#include <algorithm>
+
+SpatialGrid::SpatialGrid(float cellSize)
+{
+	this->cellSize = cellSize;
+	queryStamp = 0;
+}
+
+std::int64_t SpatialGrid::GetCellKey(int x, int y)
+{
+	return ((std::int64_t)x << 32) | (std::uint32_t)y;
+}
+
+glm::ivec2 SpatialGrid::GetCell(glm::vec2 position) const
+{
+	return glm::ivec2(glm::floor(position / cellSize));
+}
+
+SpatialGrid::Entry& SpatialGrid::GetEntry(entt::entity entity)
+{
+	auto index = entt::to_entity(entity);
+	if(index >= entries.size())
+	{
+		entries.resize(index + 1);
+	}
+	return entries[index];
+}
+
+void SpatialGrid::AddToCells(entt::entity entity, glm::ivec2 minCell, glm::ivec2 maxCell)
+{
+	for(int x = minCell.x; x <= maxCell.x; x++)
+	{
+		for(int y = minCell.y; y <= maxCell.y; y++)
+		{
+			cells[GetCellKey(x, y)].push_back(entity);
+		}
+	}
+}
+
+void SpatialGrid::RemoveFromCells(entt::entity entity, glm::ivec2 minCell, glm::ivec2 maxCell)
+{
+	for(int x = minCell.x; x <= maxCell.x; x++)
+	{
+		for(int y = minCell.y; y <= maxCell.y; y++)
+		{
+			auto cell = cells.find(GetCellKey(x, y));
+			if(cell == cells.end())
+			{
+				continue;
+			}
+			auto& list = cell->second;
+			auto it = std::find(list.begin(), list.end(), entity);
+			if(it != list.end())
+			{
+				*it = list.back();
+				list.pop_back();
+			}
+			if(list.empty())
+			{
+				cells.erase(cell);
+			}
+		}
+	}
+}
+
+void SpatialGrid::Update(entt::entity entity, const Bounds& bounds)
+{
+	auto& entry = GetEntry(entity);
+	auto minCell = GetCell(bounds.min);
+	auto maxCell = GetCell(bounds.max);
+	if(entry.inGrid && entry.minCell == minCell && entry.maxCell == maxCell)
+	{
+		entry.bounds = bounds;
+		return;
+	}
+	if(entry.inGrid)
+	{
+		RemoveFromCells(entity, entry.minCell, entry.maxCell);
+	}
+	AddToCells(entity, minCell, maxCell);
+	entry.bounds = bounds;
+	entry.minCell = minCell;
+	entry.maxCell = maxCell;
+	entry.inGrid = true;
+}
+
+void SpatialGrid::Remove(entt::entity entity)
+{
+	auto index = entt::to_entity(entity);
+	if(index >= entries.size() || !entries[index].inGrid)
+	{
+		return;
+	}
+	auto& entry = entries[index];
+	RemoveFromCells(entity, entry.minCell, entry.maxCell);
+	entry.inGrid = false;
+}
+
+void SpatialGrid::Clear()
+{
+	cells.clear();
+	entries.clear();
+}
+
+void SpatialGrid::Visit(entt::entity entity, const Bounds& area, std::vector<entt::entity>& result)
+{
+	auto& entry = entries[entt::to_entity(entity)];
+	if(entry.queryStamp == queryStamp)
+	{
+		return;
+	}
+	entry.queryStamp = queryStamp;
+	if(entry.bounds.Overlaps(area))
+	{
+		result.push_back(entity);
+	}
+}
+
+void SpatialGrid::Query(const Bounds& area, std::vector<entt::entity>& result)
+{
+	queryStamp++;
+	auto minCell = GetCell(area.min);
+	auto maxCell = GetCell(area.max);
+	auto cellCount = (std::int64_t)(maxCell.x - minCell.x + 1) * (maxCell.y - minCell.y + 1);
+	if(cellCount > (std::int64_t)cells.size())
+	{
+		for(auto& cell : cells)
+		{
+			for(auto entity : cell.second)
+			{
+				Visit(entity, area, result);
+			}
+		}
+		return;
+	}
+	for(int x = minCell.x; x <= maxCell.x; x++)
+	{
+		for(int y = minCell.y; y <= maxCell.y; y++)
+		{
+			auto cell = cells.find(GetCellKey(x, y));
+			if(cell == cells.end())
+			{
+				continue;
+			}
+			for(auto entity : cell->second)
+			{
+				Visit(entity, area, result);
+			}
+		}
+	}
+}
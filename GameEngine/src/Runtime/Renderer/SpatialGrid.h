@@ -0,0 +1,49 @@
+#pragma once
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+#include <entt/entity/entity.hpp>
+#include <glm/glm.hpp>
+
+struct Bounds
+{
+	glm::vec2 min;
+	glm::vec2 max;
+
+	bool Overlaps(const Bounds& other) const
+	{
+		return min.x <= other.max.x && max.x >= other.min.x && min.y <= other.max.y && max.y >= other.min.y;
+	}
+};
+
+//Uniform grid of world space bounds, entities are only moved between cells when their bounds change cells
+class SpatialGrid
+{
+	struct Entry
+	{
+		Bounds bounds;
+		glm::ivec2 minCell;
+		glm::ivec2 maxCell;
+		bool inGrid = false;
+		unsigned int queryStamp = 0;
+	};
+
+	float cellSize;
+	std::unordered_map<std::int64_t, std::vector<entt::entity>> cells;
+	std::vector<Entry> entries;
+	unsigned int queryStamp;
+
+	static std::int64_t GetCellKey(int x, int y);
+	glm::ivec2 GetCell(glm::vec2 position) const;
+	Entry& GetEntry(entt::entity entity);
+	void AddToCells(entt::entity entity, glm::ivec2 minCell, glm::ivec2 maxCell);
+	void RemoveFromCells(entt::entity entity, glm::ivec2 minCell, glm::ivec2 maxCell);
+	void Visit(entt::entity entity, const Bounds& area, std::vector<entt::entity>& result);
+public:
+	SpatialGrid(float cellSize = 4.0f);
+	void Update(entt::entity entity, const Bounds& bounds);
+	void Remove(entt::entity entity);
+	void Clear();
+	void Query(const Bounds& area, std::vector<entt::entity>& result);
+};
@@ -0,0 +1,163 @@
+#include "Renderer/SpriteBatch.h"
+
+#include <algorithm>
+#include <climits>
+
+SpriteBatch::SpriteBatch(SDL_Renderer* renderer)
+{
+	this->renderer = renderer;
+	prepared = false;
+}
+
+void SpriteBatch::Begin()
+{
+	quads.clear();
+	staticRuns.clear();
+	staticPositions.clear();
+	staticColors.clear();
+	staticUvs.clear();
+	stats = BatchStats();
+	prepared = false;
+}
+
+void SpriteBatch::Add(int layer, std::uint32_t textureKey, SDL_Texture* texture, SDL_BlendMode blendMode, const SDL_Vertex(&quadVertices)[4])
+{
+	SpriteQuad quad;
+	quad.layer = layer;
+	quad.textureKey = textureKey;
+	quad.texture = texture;
+	quad.blendMode = blendMode;
+	std::copy(quadVertices, quadVertices + 4, quad.vertices);
+	quads.push_back(quad);
+}
+
+SpriteQuad* SpriteBatch::Allocate(int count)
+{
+	int first = quads.size();
+	quads.resize(first + count);
+	return quads.data() + first;
+}
+
+float* SpriteBatch::AddStatic(int layer, SDL_Texture* texture, SDL_BlendMode blendMode, const SDL_Color* colors, const float* uvs, int quadCount)
+{
+	int firstVertex = staticColors.size();
+	staticRuns.push_back({layer, texture, blendMode, firstVertex, quadCount});
+	staticColors.insert(staticColors.end(), colors, colors + quadCount * 4);
+	staticUvs.insert(staticUvs.end(), uvs, uvs + quadCount * 8);
+	staticPositions.resize(staticPositions.size() + quadCount * 8);
+	return &staticPositions[firstVertex * 2];
+}
+
+void SpriteBatch::Sort()
+{
+	order.resize(quads.size());
+	for(int i = 0; i < order.size(); i++)
+	{
+		order[i] = i;
+	}
+	std::stable_sort(order.begin(), order.end(), [this](int lhs, int rhs)
+		{
+			const auto& a = quads[lhs];
+			const auto& b = quads[rhs];
+			if(a.layer != b.layer)
+			{
+				return a.layer < b.layer;
+			}
+			if(a.textureKey != b.textureKey)
+			{
+				return a.textureKey < b.textureKey;
+			}
+			return a.blendMode < b.blendMode;
+		});
+}
+
+void SpriteBatch::ReserveIndices(int quadCount)
+{
+	int builtQuads = indices.size() / 6;
+	if(builtQuads >= quadCount)
+	{
+		return;
+	}
+	indices.resize(quadCount * 6);
+	for(int i = builtQuads; i < quadCount; i++)
+	{
+		int v = i * 4;
+		indices[i * 6 + 0] = v + 0;
+		indices[i * 6 + 1] = v + 1;
+		indices[i * 6 + 2] = v + 2;
+		indices[i * 6 + 3] = v + 0;
+		indices[i * 6 + 4] = v + 2;
+		indices[i * 6 + 5] = v + 3;
+	}
+}
+
+void SpriteBatch::Submit(SDL_Texture* texture, SDL_BlendMode blendMode, int firstQuad, int quadCount)
+{
+	SDL_SetTextureBlendMode(texture, blendMode);
+	SDL_RenderGeometry(renderer, texture, &vertices[firstQuad * 4], quadCount * 4, indices.data(), quadCount * 6);
+	stats.drawCalls++;
+}
+
+void SpriteBatch::SubmitStaticRuns(int maxLayer, int& nextRun)
+{
+	for(; nextRun < staticRuns.size() && staticRuns[nextRun].layer <= maxLayer; nextRun++)
+	{
+		const auto& run = staticRuns[nextRun];
+		ReserveIndices(run.quadCount);
+		SDL_SetTextureBlendMode(run.texture, run.blendMode);
+		SDL_RenderGeometryRaw(renderer, run.texture, &staticPositions[run.firstVertex * 2], sizeof(float) * 2, &staticColors[run.firstVertex], sizeof(SDL_Color),
+			&staticUvs[run.firstVertex * 2], sizeof(float) * 2, run.quadCount * 4, indices.data(), run.quadCount * 6, sizeof(int));
+		stats.sprites += run.quadCount;
+		stats.drawCalls++;
+	}
+}
+
+void SpriteBatch::Prepare()
+{
+	stats.sprites = quads.size();
+	if(!quads.empty())
+	{
+		Sort();
+		vertices.resize(quads.size() * 4);
+		for(int i = 0; i < order.size(); i++)
+		{
+			std::copy(quads[order[i]].vertices, quads[order[i]].vertices + 4, &vertices[i * 4]);
+		}
+		ReserveIndices(quads.size());
+	}
+	prepared = true;
+}
+
+void SpriteBatch::End()
+{
+	if(!prepared)
+	{
+		Prepare();
+	}
+	int nextStaticRun = 0;
+	if(!quads.empty())
+	{
+		int runStart = 0;
+		for(int i = 1; i <= order.size(); i++)
+		{
+			const auto& first = quads[order[runStart]];
+			if(i < order.size())
+			{
+				const auto& current = quads[order[i]];
+				if(current.layer == first.layer && current.texture == first.texture && current.blendMode == first.blendMode)
+				{
+					continue;
+				}
+			}
+			SubmitStaticRuns(first.layer, nextStaticRun);
+			Submit(first.texture, first.blendMode, runStart, i - runStart);
+			runStart = i;
+		}
+	}
+	SubmitStaticRuns(INT_MAX, nextStaticRun);
+}
+
+const BatchStats& SpriteBatch::GetStats() const
+{
+	return stats;
+}
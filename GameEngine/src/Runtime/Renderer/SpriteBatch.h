@@ -0,0 +1,73 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+
+#include <SDL2/SDL.h>
+
+struct SpriteQuad
+{
+	int layer;
+	//Sort key of the texture, pointers are not used so the order is the same on every run
+	std::uint32_t textureKey;
+	SDL_Texture* texture;
+	SDL_BlendMode blendMode;
+	SDL_Vertex vertices[4];
+};
+
+//Prebuilt quads drawn as a single call, the vertex data is stored in the batch
+struct StaticSpriteRun
+{
+	int layer;
+	SDL_Texture* texture;
+	SDL_BlendMode blendMode;
+	int firstVertex;
+	int quadCount;
+};
+
+struct BatchStats
+{
+	int sprites = 0;
+	int drawCalls = 0;
+
+	int GetSavedDrawCalls() const
+	{
+		return sprites - drawCalls;
+	}
+};
+
+//Collects sprite quads for a frame and submits one SDL_RenderGeometry call per run of (layer, texture, blend mode).
+//Quads are stable sorted by layer, texture key and blend mode, so quads that share all three keep the order they were added in.
+//A batch owns all of its frame data so it can be filled and prepared on one thread and submitted on another.
+class SpriteBatch
+{
+	SDL_Renderer* renderer;
+	std::vector<SpriteQuad> quads;
+	std::vector<StaticSpriteRun> staticRuns;
+	std::vector<float> staticPositions;
+	std::vector<SDL_Color> staticColors;
+	std::vector<float> staticUvs;
+	std::vector<int> order;
+	std::vector<SDL_Vertex> vertices;
+	std::vector<int> indices;
+	BatchStats stats;
+	bool prepared;
+
+	void Sort();
+	void ReserveIndices(int quadCount);
+	void Submit(SDL_Texture* texture, SDL_BlendMode blendMode, int firstQuad, int quadCount);
+	void SubmitStaticRuns(int maxLayer, int& nextRun);
+public:
+	SpriteBatch(SDL_Renderer* renderer = nullptr);
+	void Begin();
+	void Add(int layer, std::uint32_t textureKey, SDL_Texture* texture, SDL_BlendMode blendMode, const SDL_Vertex(&quadVertices)[4]);
+	//Returns space for count quads to be filled by the caller before End
+	SpriteQuad* Allocate(int count);
+	//Runs must be added in layer order, they are drawn before the quads of the same layer.
+	//Returns space for the screen positions of the run to be filled by the caller before End
+	float* AddStatic(int layer, SDL_Texture* texture, SDL_BlendMode blendMode, const SDL_Color* colors, const float* uvs, int quadCount);
+	//Sorts the quads and lays out their vertices, makes no SDL calls so it can run off the render thread
+	void Prepare();
+	//Issues the draw calls, must run on the thread that owns the renderer
+	void End();
+	const BatchStats& GetStats() const;
+};
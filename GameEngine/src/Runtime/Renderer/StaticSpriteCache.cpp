@@ -0,0 +1,130 @@
+#include "Renderer/StaticSpriteCache.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "Core/Affine.h"
+
+//Runs are split after this many quads so the parts of a large tile map outside the camera can be skipped
+const int MAX_RUN_QUADS = 128;
+
+StaticSpriteCache::StaticSpriteCache()
+{
+	dirty = true;
+	screenMatrix = glm::mat3(0);
+}
+
+void StaticSpriteCache::Invalidate()
+{
+	dirty = true;
+}
+
+bool StaticSpriteCache::IsDirty() const
+{
+	return dirty;
+}
+
+bool StaticSpriteCache::Contains(entt::entity entity) const
+{
+	auto index = entt::to_entity(entity);
+	return index < cached.size() && cached[index];
+}
+
+void StaticSpriteCache::Clear()
+{
+	sprites.clear();
+	cached.clear();
+	dirty = true;
+}
+
+void StaticSpriteCache::Add(entt::entity entity, int layer, std::uint32_t textureKey, SDL_Texture* texture, const Affine& matrix, glm::vec2 extents, const SDL_FPoint(&quadUvs)[4], SDL_Color color)
+{
+	auto index = entt::to_entity(entity);
+	if(index >= cached.size())
+	{
+		cached.resize(index + 1, false);
+	}
+	cached[index] = true;
+
+	StaticSprite sprite;
+	sprite.layer = layer;
+	sprite.textureKey = textureKey;
+	sprite.texture = texture;
+	sprite.corners[0] = matrix.Apply({-extents.x,extents.y});
+	sprite.corners[1] = matrix.Apply({extents.x,extents.y});
+	sprite.corners[2] = matrix.Apply({extents.x,-extents.y});
+	sprite.corners[3] = matrix.Apply({-extents.x,-extents.y});
+	std::copy(quadUvs, quadUvs + 4, sprite.uvs);
+	sprite.color = color;
+	sprites.push_back(sprite);
+}
+
+void StaticSpriteCache::Build()
+{
+	std::stable_sort(sprites.begin(), sprites.end(), [](const StaticSprite& lhs, const StaticSprite& rhs)
+		{
+			if(lhs.layer != rhs.layer)
+			{
+				return lhs.layer < rhs.layer;
+			}
+			return lhs.textureKey < rhs.textureKey;
+		});
+	worldPositions.resize(sprites.size() * 8);
+	screenPositions.resize(sprites.size() * 8);
+	colors.resize(sprites.size() * 4);
+	uvs.resize(sprites.size() * 8);
+	runs.clear();
+	for(int i = 0; i < sprites.size(); i++)
+	{
+		const auto& sprite = sprites[i];
+		for(int v = 0; v < 4; v++)
+		{
+			int vertex = i * 4 + v;
+			worldPositions[vertex * 2] = sprite.corners[v].x;
+			worldPositions[vertex * 2 + 1] = sprite.corners[v].y;
+			uvs[vertex * 2] = sprite.uvs[v].x;
+			uvs[vertex * 2 + 1] = sprite.uvs[v].y;
+			colors[vertex] = sprite.color;
+		}
+		auto spriteBounds = Bounds{glm::min(glm::min(sprite.corners[0], sprite.corners[1]), glm::min(sprite.corners[2], sprite.corners[3])),
+			glm::max(glm::max(sprite.corners[0], sprite.corners[1]), glm::max(sprite.corners[2], sprite.corners[3]))};
+		if(runs.empty() || runs.back().layer != sprite.layer || runs.back().texture != sprite.texture || runs.back().quadCount >= MAX_RUN_QUADS)
+		{
+			runs.push_back({sprite.layer, sprite.texture, i, 0, spriteBounds, false});
+		}
+		auto& run = runs.back();
+		run.quadCount++;
+		run.bounds.min = glm::min(run.bounds.min, spriteBounds.min);
+		run.bounds.max = glm::max(run.bounds.max, spriteBounds.max);
+	}
+	sprites.clear();
+	dirty = false;
+}
+
+void StaticSpriteCache::Submit(SpriteBatch& batch, const glm::mat3& worldToScreen, const Bounds& cameraBounds)
+{
+	if(worldToScreen != screenMatrix)
+	{
+		screenMatrix = worldToScreen;
+		for(auto& run : runs)
+		{
+			run.screenValid = false;
+		}
+	}
+	auto screenTransform = Affine(worldToScreen);
+	for(auto& run : runs)
+	{
+		if(!run.bounds.Overlaps(cameraBounds))
+		{
+			continue;
+		}
+		int firstVertex = run.firstQuad * 4;
+		if(!run.screenValid)
+		{
+			TransformPositions(screenTransform, &worldPositions[firstVertex * 2], &screenPositions[firstVertex * 2], run.quadCount * 4);
+			run.screenValid = true;
+		}
+		float* batchPositions = batch.AddStatic(run.layer, run.texture, SDL_BLENDMODE_BLEND, &colors[firstVertex], &uvs[firstVertex * 2], run.quadCount);
+		std::memcpy(batchPositions, &screenPositions[firstVertex * 2], sizeof(float) * run.quadCount * 8);
+	}
+}
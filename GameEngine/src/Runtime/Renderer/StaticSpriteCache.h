@@ -0,0 +1,55 @@
+#pragma once
+#include <vector>
+
+#include <SDL2/SDL.h>
+#include <entt/entity/entity.hpp>
+#include <glm/glm.hpp>
+
+#include "Core/Affine.h"
+#include "Renderer/SpriteBatch.h"
+#include "Renderer/SpatialGrid.h"
+
+//World space geometry of static sprites grouped by layer and texture.
+//Runs outside the camera are skipped and screen positions are only recomputed when the world to screen matrix changes
+class StaticSpriteCache
+{
+	struct Run
+	{
+		int layer;
+		SDL_Texture* texture;
+		int firstQuad;
+		int quadCount;
+		Bounds bounds;
+		//Whether the run's screen positions match screenMatrix
+		bool screenValid;
+	};
+
+	struct StaticSprite
+	{
+		int layer;
+		std::uint32_t textureKey;
+		SDL_Texture* texture;
+		glm::vec2 corners[4];
+		SDL_FPoint uvs[4];
+		SDL_Color color;
+	};
+
+	std::vector<StaticSprite> sprites;
+	std::vector<bool> cached;
+	std::vector<float> worldPositions;
+	std::vector<float> screenPositions;
+	glm::mat3 screenMatrix;
+	std::vector<SDL_Color> colors;
+	std::vector<float> uvs;
+	std::vector<Run> runs;
+	bool dirty;
+public:
+	StaticSpriteCache();
+	void Invalidate();
+	bool IsDirty() const;
+	bool Contains(entt::entity entity) const;
+	void Clear();
+	void Add(entt::entity entity, int layer, std::uint32_t textureKey, SDL_Texture* texture, const Affine& matrix, glm::vec2 extents, const SDL_FPoint(&quadUvs)[4], SDL_Color color);
+	void Build();
+	void Submit(SpriteBatch& batch, const glm::mat3& worldToScreen, const Bounds& cameraBounds);
+};
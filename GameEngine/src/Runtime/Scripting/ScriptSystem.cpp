@@ -1,15 +1,14 @@
 #include "Scripting/ScriptSystem.h"
 
-#include <set>
-
 #include "Core/Entity.h"
 #include "AssetPipline/AssetStore.h"
 #include "AssetPipline/ScriptAsset.h"
 
 #include "Core/Transform.h"
 #include "Core/TimeSystem.h"
-#include "Core/DisableSystem.h"
 #include "Core/LevelTree.h"
+#include "Levels/PrefabSystem.h"
+#include "Physics/Physics.h"
 
 #include "Core/Systems.h"
 
@@ -38,6 +37,7 @@ static void Translate(entt::entity entity, glm::vec2 translation)
 	auto& transform = ROSE_GETSYSTEM(EntitySystem).GetRegistry().get<TransformComponent>(entity);
 	transform.globalPosition += translation;
 	transform.UpdateLocals();
+	ROSE_GETSYSTEM(TransformSystem).MarkDirty(entity);
 }
 static void Translate(entt::entity entity, float x, float y)
 {
@@ -56,29 +56,105 @@ static void FaceDir(entt::entity entity, int dir)
 	auto& transform = ROSE_GETSYSTEM(EntitySystem).GetRegistry().get<TransformComponent>(entity);
 	transform.scale.x = glm::abs(transform.scale.x) * dir;
 	transform.UpdateGlobals();
+	ROSE_GETSYSTEM(TransformSystem).MarkDirty(entity);
 }
 static void DisableEntity(entt::entity entity)
 {
-	ROSE_GETSYSTEM(DisableSystem).Disable(entity);
+	ROSE_GETSYSTEM(EntitySystem).GetCommands().Disable(entity);
 }
 static void EnableEntity(entt::entity entity)
 {
-	ROSE_GETSYSTEM(DisableSystem).Enable(entity);
+	ROSE_GETSYSTEM(EntitySystem).GetCommands().Enable(entity);
 }
-static std::set<entt::entity> destroyCalls;
 static void DestroyEntity(entt::entity entity)
 {
-	destroyCalls.insert(entity);
+	//Instances of pooled prefabs go back to their pool
+	auto& commands = ROSE_GETSYSTEM(EntitySystem).GetCommands();
+	if(ROSE_GETSYSTEM(PrefabSystem).IsPooledInstance(entity))
+	{
+		commands.Release(entity);
+	} else
+	{
+		commands.Destroy(entity);
+	}
+}
+static sol::as_table_t<std::vector<entt::entity>> CreateEntities(int count, sol::optional<entt::entity> parent)
+{
+	//Handles are reserved now and get their GUIDs and tree nodes when the commands are played
+	auto& entities = ROSE_GETSYSTEM(EntitySystem);
+	std::vector<entt::entity> created(glm::max(count, 0));
+	entities.GetRegistry().create(created.begin(), created.end());
+	entities.GetCommands().Spawn([created, parent = parent.value_or(NoEntity())]()
+		{
+			ROSE_GETSYSTEM(EntitySystem).AddEntities(created.data(), created.size(), parent);
+		});
+	return sol::as_table(std::move(created));
+}
+//spawn and spawn_many are played with the entity commands after the scripts, the returned roots can be stored,
+//destroyed or parented right away but have no components until then, so get_position and the like wait a frame
+static entt::entity SpawnPrefab(const std::string& prefab, glm::vec2 position)
+{
+	return ROSE_GETSYSTEM(PrefabSystem).QueueSpawn(ROSE_GETSYSTEM(AssetStore).GetAssetId(prefab), position);
+}
+static sol::as_table_t<std::vector<entt::entity>> SpawnPrefabs(const std::string& prefab, sol::table positionTable)
+{
+	std::vector<glm::vec2> positions;
+	positions.reserve(positionTable.size());
+	for(int i = 1; i <= positionTable.size(); i++)
+	{
+		positions.push_back(positionTable.get<glm::vec2>(i));
+	}
+	return sol::as_table(ROSE_GETSYSTEM(PrefabSystem).QueueSpawn(ROSE_GETSYSTEM(AssetStore).GetAssetId(prefab), positions.data(), positions.size()));
+}
+static void SetPoolSize(const std::string& prefab, int size)
+{
+	ROSE_GETSYSTEM(PrefabSystem).SetPoolSize(ROSE_GETSYSTEM(AssetStore).GetAssetId(prefab), size);
 }
 static entt::entity FindEntity(std::string entityName)
 {
 	return ROSE_GETSYSTEM(LevelTree).FindEntity(entityName);
 }
+static sol::as_table_t<std::vector<entt::entity>> FindEntities(const std::string& entityName)
+{
+	std::vector<entt::entity> entities;
+	ROSE_GETSYSTEM(LevelTree).FindEntities(entityName, entities);
+	return sol::as_table(std::move(entities));
+}
 static glm::vec2 GetPos(entt::entity entity)
 {
 	auto& transform = ROSE_GETSYSTEM(EntitySystem).GetRegistry().get<TransformComponent>(entity);
 	return transform.globalPosition;
 }
+static RaycastHit Raycast(glm::vec2 from, glm::vec2 to, sol::optional<unsigned int> mask)
+{
+	return ROSE_GETSYSTEM(PhysicsSystem).Raycast(from, to, mask.value_or(PhysicsSystem::AllLayers));
+}
+//Rays are given as two tables of start and end points so many vision checks cross into C++ once
+static sol::as_table_t<std::vector<RaycastHit>> RaycastMany(sol::table fromTable, sol::table toTable, sol::optional<unsigned int> mask)
+{
+	std::vector<Ray> rays;
+	int count = glm::min(fromTable.size(), toTable.size());
+	rays.reserve(count);
+	for(int i = 1; i <= count; i++)
+	{
+		rays.push_back({fromTable.get<glm::vec2>(i), toTable.get<glm::vec2>(i)});
+	}
+	std::vector<RaycastHit> hits(count);
+	ROSE_GETSYSTEM(PhysicsSystem).Raycast(rays.data(), count, hits.data(), mask.value_or(PhysicsSystem::AllLayers));
+	return sol::as_table(std::move(hits));
+}
+static sol::as_table_t<std::vector<entt::entity>> OverlapBox(glm::vec2 center, glm::vec2 size, sol::optional<unsigned int> mask)
+{
+	std::vector<entt::entity> entities;
+	ROSE_GETSYSTEM(PhysicsSystem).OverlapBox(center, size, 0, entities, mask.value_or(PhysicsSystem::AllLayers));
+	return sol::as_table(std::move(entities));
+}
+static sol::as_table_t<std::vector<entt::entity>> OverlapCircle(glm::vec2 center, float radius, sol::optional<unsigned int> mask)
+{
+	std::vector<entt::entity> entities;
+	ROSE_GETSYSTEM(PhysicsSystem).OverlapCircle(center, radius, entities, mask.value_or(PhysicsSystem::AllLayers));
+	return sol::as_table(std::move(entities));
+}
 
 void ScriptSystem::ScriptComponentCreated(entt::registry& registry, entt::entity entity)
 {
@@ -131,16 +207,17 @@ void ScriptSystem::Update()
 	setupNextFrame.clear();
 	auto view = registry.view<ScriptComponent>(entt::exclude<DisableComponent>);
 	auto dt = ROSE_GETSYSTEM(TimeSystem).GetdeltaTime();
+	auto& commands = ROSE_GETSYSTEM(EntitySystem).GetCommands();
 	for(auto entity : view)
 	{
-		if(destroyCalls.find(entity) != destroyCalls.end())
+		if(commands.IsDestroyQueued(entity))
 		{
 			continue;
 		}
 		auto& scriptComponent = registry.get<ScriptComponent>(entity);
 		for(auto& script : scriptComponent.scripts)
 		{
-			if(destroyCalls.find(entity) != destroyCalls.end())
+			if(commands.IsDestroyQueued(entity))
 			{
 				break;
 			}
@@ -152,11 +229,11 @@ void ScriptSystem::Update()
 			}
 		}
 	}
-	for(auto entity : destroyCalls)
-	{
-		ROSE_GETSYSTEM(EntitySystem).DestroyEntity(entity);
-	}
-	destroyCalls.clear();
+}
+
+void ScriptSystem::ResetScripts(entt::entity entity)
+{
+	setupNextFrame.insert(entity);
 }
 
 void ScriptSystem::CallEvent(EntityEvent eventData)
@@ -188,6 +265,12 @@ void ScriptSystem::AddScript(entt::entity entity, const std::string scriptName,
 		"target", &EntityEvent::target,
 		"input_key", &EntityEvent::inputKey
 	);
+	state.new_usertype<RaycastHit>("RaycastHit",
+		"entity", &RaycastHit::entity,
+		"point", &RaycastHit::point,
+		"normal", &RaycastHit::normal,
+		"fraction", &RaycastHit::fraction
+	);
 	state.new_usertype<glm::vec2>("vec2",
 		"x", &glm::vec2::x,
 		"y", &glm::vec2::y,
@@ -207,8 +290,17 @@ void ScriptSystem::AddScript(entt::entity entity, const std::string scriptName,
 	state.set_function("enable", EnableEntity);
 	state.set_function("get_name", GetEntityName);
 	state.set_function("destroy", DestroyEntity);
+	state.set_function("create_entities", CreateEntities);
+	state.set_function("spawn", SpawnPrefab);
+	state.set_function("spawn_many", SpawnPrefabs);
+	state.set_function("set_pool_size", SetPoolSize);
 	state.set_function("find", FindEntity);
+	state.set_function("find_all", FindEntities);
 	state.set_function("get_position", GetPos);
+	state.set_function("raycast", Raycast);
+	state.set_function("raycast_many", RaycastMany);
+	state.set_function("overlap_box", OverlapBox);
+	state.set_function("overlap_circle", OverlapCircle);
 	state["no_entity"] = NoEntity();
 	state.script(script);
 }
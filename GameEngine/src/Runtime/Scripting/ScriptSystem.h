@@ -20,5 +20,7 @@ public:
 	void CallEvent(EntityEvent eventData);
 	void AddScript(entt::entity entity, const std::string scriptName, const std::string script);
 	void RefreshScript(entt::entity entity);
+	//Runs setup again on the existing script states next frame, used when pooled entities are reused
+	void ResetScripts(entt::entity entity);
 	void RemoveScript(entt::entity entity, const std::string& removeScript);
 };
\ No newline at end of file
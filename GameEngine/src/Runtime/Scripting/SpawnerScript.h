@@ -1,6 +1,8 @@
 #pragma once
 #include "Scripting/Script.h"
 
+#include <deque>
+
 #include <entt/entt.hpp>
 
 #include "Core/TimeSystem.h"
@@ -8,27 +10,46 @@
 
 #include "Core/Systems.h"
 
+#include "Levels/PrefabSystem.h"
+#include "AssetPipline/AssetStore.h"
+
 #include "Components/TransformComponent.h"
-#include "Components/PhysicsBodyComponent.h"
 
 class SpawnerScript : public Script {
 private:
 	float spawnDelay;
 	float currentTime;
+	AssetId prefab;
+	//Oldest first, the oldest orb goes back to the pool once maxAlive are out
+	std::deque<entt::entity> alive;
+	int maxAlive;
 public:
 	virtual void Setup(entt::entity owner) override {
 		spawnDelay = 5;
 		currentTime = 0;
+		maxAlive = 4;
+		prefab = ROSE_GETSYSTEM(AssetStore).GetAssetId("Orb");
+		ROSE_GETSYSTEM(PrefabSystem).SetPoolSize(prefab, maxAlive);
 	}
 	virtual void Update(entt::entity owner) override {
 		auto& timeSystem = ROSE_GETSYSTEM(TimeSystem);
 		currentTime += timeSystem.GetdeltaTime();
 		if (currentTime > spawnDelay) {
 			currentTime = 0;
-			auto& entities = ROSE_GETSYSTEM(EntitySystem);
-			auto entity = entities.CreateEntity();
-			entities.GetRegistry().emplace<TransformComponent>(entity);
-			entities.GetRegistry().emplace<PhysicsBodyComponent>(entity);
+			auto& registry = ROSE_GETSYSTEM(EntitySystem).GetRegistry();
+			auto position = registry.all_of<TransformComponent>(owner) ? registry.get<TransformComponent>(owner).globalPosition : glm::vec2(0, 0);
+			auto& prefabs = ROSE_GETSYSTEM(PrefabSystem);
+			auto& commands = ROSE_GETSYSTEM(EntitySystem).GetCommands();
+			alive.push_back(prefabs.QueueSpawn(prefab, position));
+			if (alive.size() > maxAlive) {
+				auto oldest = alive.front();
+				alive.pop_front();
+				if (prefabs.IsPooledInstance(oldest)) {
+					commands.Release(oldest);
+				} else if (registry.valid(oldest)) {
+					commands.Destroy(oldest);
+				}
+			}
 		}
 	}
 };
\ No newline at end of file
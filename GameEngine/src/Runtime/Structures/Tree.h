@@ -1,37 +0,0 @@
-#pragma once
-#include <unordered_set>
-
-template<typename T>
-struct Node {
-	Node* parent;
-	T element;
-	std::unordered_set<Node*> children;
-	Node(T element, Node* parent = nullptr) {
-		this->element = element;
-		this->parent = nullptr;
-		if (parent != nullptr) {
-			parent->AddChild(this);
-		}
-	}
-	void RemoveChild(Node* child) {
-		child->parent = nullptr;
-		if (children.find(child) != children.end()) {
-			children.erase(child);
-		}
-	}
-	void AddChild(Node* child) {
-		if (child->parent != nullptr) {
-			child->parent->RemoveChild(child);
-		}
-		child->parent = this;
-		children.insert(child);
-	}
-	void DeleteChildren() {
-		for (auto p : children) {
-			delete p;
-		}
-		children.clear();
-	}
-	~Node() {
-	}
-};
\ No newline at end of file
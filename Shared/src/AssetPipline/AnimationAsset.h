@@ -41,6 +41,8 @@ class Animation :public Asset {
 
 public:
 	std::string texture;
+	//Resolved by the asset store when the animation is loaded
+	AssetId textureId;
 	bool isLooping;
 	std::vector<Frame*> frames;
 	std::vector<AnimationEventData*> animationEvents;
@@ -19,6 +19,9 @@ std::string Asset::GetAssetTypeName(AssetType type)
 	case AssetType::Script:
 		return "Script";
 		break;
+	case AssetType::Prefab:
+		return "Prefab";
+		break;
 	default:
 		return "Unknown";
 		break;
@@ -35,6 +38,9 @@ AssetType Asset::GetAssetFileType(const std::string& file) {
 	if (extension == ".anim") {
 		return AssetType::Animation;
 	}
+	if (extension == ".prefab") {
+		return AssetType::Prefab;
+	}
 	if (extension == ".png" || extension == ".jpg") {
 		return AssetType::Texture;
 	}
@@ -47,3 +53,24 @@ AssetHandle::AssetHandle(AssetType type, Asset* asset)
 	asset(asset)
 {
 }
+
+AssetId::AssetId(std::uint32_t index, std::uint32_t generation)
+	:index(index),
+	generation(generation)
+{
+}
+
+bool AssetId::IsValid() const
+{
+	return index != INVALID_ASSET_INDEX;
+}
+
+bool AssetId::operator==(const AssetId& other) const
+{
+	return index == other.index && generation == other.generation;
+}
+
+bool AssetId::operator!=(const AssetId& other) const
+{
+	return !(*this == other);
+}
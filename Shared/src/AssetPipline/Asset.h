@@ -1,11 +1,13 @@
 #pragma once
 #include <string>
+#include <cstdint>
 
 enum class AssetType {
 	Empty,
 	Texture,
 	Animation,
-	Script
+	Script,
+	Prefab
 };
 
 class Asset {
@@ -19,4 +21,16 @@ public:
 	Asset* asset;
 	AssetType type;
 	AssetHandle(AssetType type = AssetType::Empty, Asset* asset = nullptr);
+};
+
+const std::uint32_t INVALID_ASSET_INDEX = UINT32_MAX;
+
+//Interned asset name, the generation changes whenever the asset behind the name is replaced or unloaded
+struct AssetId {
+	std::uint32_t index;
+	std::uint32_t generation;
+	AssetId(std::uint32_t index = INVALID_ASSET_INDEX, std::uint32_t generation = 0);
+	bool IsValid() const;
+	bool operator==(const AssetId& other) const;
+	bool operator!=(const AssetId& other) const;
 };
\ No newline at end of file
@@ -1,5 +1,7 @@
 #include "AssetStore.h"
 
+#include <algorithm>
+
 #include <sdl2/SDL_image.h>
 
 #include "AnimationImporter.h"
@@ -11,6 +13,10 @@
 #include "AssetPackage.h"
 
 #include "ScriptAsset.h"
+#include "PrefabAsset.h"
+#include "SkylinePacker.h"
+
+const int ATLAS_PADDING = 1;
 
 AssetStore::AssetStore()
 {
@@ -23,12 +29,23 @@ AssetStore::~AssetStore()
 
 void AssetStore::UnloadAllAssets()
 {
-	for(auto& asset : assets)
+	for(auto& slot : slots)
+	{
+		delete slot.handle.asset;
+		slot.handle = AssetHandle();
+		slot.generation++;
+	}
+	if(SDL_WasInit(0) != 0)
 	{
-		delete asset.second.asset;
-		asset.second.asset = nullptr;
+		for(auto& package : atlasPages)
+		{
+			for(auto page : package.second)
+			{
+				SDL_DestroyTexture(page);
+			}
+		}
 	}
-	assets.clear();
+	atlasPages.clear();
 }
 
 void AssetStore::AddTexture(const std::string& assetId, const std::string& filePath, int ppu)
@@ -38,35 +55,135 @@ void AssetStore::AddTexture(const std::string& assetId, const std::string& fileP
 	SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
 	SDL_FreeSurface(surface);
 	auto textureAsset = new TextureAsset(texture, ppu);
-	if(assets.find(assetId) != assets.end())
+	textureAsset->sortKey = InternName(assetId);
+	SetAsset(assetId, AssetType::Texture, textureAsset);
+}
+
+AssetHandle& AssetStore::SetAsset(const std::string& assetId, AssetType type, Asset* asset)
+{
+	auto& slot = slots[InternName(assetId)];
+	if(slot.handle.asset != nullptr)
 	{
-		delete assets[assetId].asset;
-		assets[assetId].type = AssetType::Texture;
-		assets[assetId].asset = textureAsset;
-		ROSE_LOG("Reloaded Texture Asset %s", assetId.c_str());
+		delete slot.handle.asset;
+		ROSE_LOG("Reloaded %s Asset %s", Asset::GetAssetTypeName(type).c_str(), assetId.c_str());
 	} else
 	{
-		assets[assetId] = AssetHandle(AssetType::Texture, textureAsset);
-		ROSE_LOG("Loaded New Texture Asset %s", assetId.c_str());
+		ROSE_LOG("Loaded New %s Asset %s", Asset::GetAssetTypeName(type).c_str(), assetId.c_str());
 	}
+	slot.handle = AssetHandle(type, asset);
+	slot.generation++;
+	return slot.handle;
 }
 
-void AssetStore::LoadAnimation(const std::string& assetId, const std::string& filePath)
+void AssetStore::PackTextures(const std::vector<AssetFile*>& textureFiles, int atlasPageSize, std::vector<SDL_Texture*>& pages)
 {
-	auto animation = AnimationImporter::LoadAnimation(filePath);
-	if(assets.find(assetId) != assets.end())
+	SDL_Renderer* renderer = ROSE_GETSYSTEM(SdlContainer).GetRenderer();
+	std::vector<std::pair<AssetFile*, SDL_Surface*>> pending;
+	for(auto assetFile : textureFiles)
 	{
-		delete assets[assetId].asset;
-		assets[assetId].type = AssetType::Animation;
-		assets[assetId].asset = animation;
-		ROSE_LOG("Reloaded Animation Asset %s", assetId.c_str());
-	} else
+		auto metaData = (TextureMetaData*)(assetFile->metaData);
+		SDL_Surface* surface = IMG_Load(assetFile->filePath.c_str());
+		if(surface == nullptr || surface->w + ATLAS_PADDING * 2 > atlasPageSize || surface->h + ATLAS_PADDING * 2 > atlasPageSize)
+		{
+			SDL_FreeSurface(surface);
+			AddTexture(metaData->name, assetFile->filePath, metaData->ppu);
+			continue;
+		}
+		pending.push_back({assetFile, surface});
+	}
+	std::stable_sort(pending.begin(), pending.end(), [](const auto& lhs, const auto& rhs)
+		{
+			return lhs.second->h > rhs.second->h;
+		});
+
+	SkylinePacker packer;
+	std::vector<SDL_Rect> regions(pending.size());
+	std::vector<bool> packed(pending.size(), false);
+	int packedCount = 0;
+	while(packedCount < pending.size())
 	{
-		assets[assetId] = AssetHandle(AssetType::Animation, animation);
-		ROSE_LOG("Loaded New Animation Asset %s", assetId.c_str());
+		packer.Reset(atlasPageSize, atlasPageSize);
+		std::vector<int> pageItems;
+		for(int i = 0; i < pending.size(); i++)
+		{
+			if(packed[i])
+			{
+				continue;
+			}
+			SDL_Rect rect;
+			if(packer.Insert(pending[i].second->w + ATLAS_PADDING * 2, pending[i].second->h + ATLAS_PADDING * 2, rect))
+			{
+				regions[i] = {rect.x + ATLAS_PADDING, rect.y + ATLAS_PADDING, pending[i].second->w, pending[i].second->h};
+				packed[i] = true;
+				pageItems.push_back(i);
+			}
+		}
+		packedCount += pageItems.size();
+
+		SDL_Surface* pageSurface = SDL_CreateRGBSurfaceWithFormat(0, atlasPageSize, packer.GetUsedHeight(), 32, SDL_PIXELFORMAT_RGBA32);
+		for(auto i : pageItems)
+		{
+			SDL_Rect destination = regions[i];
+			SDL_SetSurfaceBlendMode(pending[i].second, SDL_BLENDMODE_NONE);
+			SDL_BlitSurface(pending[i].second, nullptr, pageSurface, &destination);
+		}
+		SDL_Texture* pageTexture = SDL_CreateTextureFromSurface(renderer, pageSurface);
+		SDL_FreeSurface(pageSurface);
+		pages.push_back(pageTexture);
+		//Textures of a page share one sort key so their sprites stay in one draw call
+		std::uint32_t pageKey = InternName(((TextureMetaData*)(pending[pageItems[0]].first->metaData))->name);
+		for(auto i : pageItems)
+		{
+			auto metaData = (TextureMetaData*)(pending[i].first->metaData);
+			auto textureAsset = new TextureAsset(pageTexture, metaData->ppu, regions[i]);
+			textureAsset->sortKey = pageKey;
+			SetAsset(metaData->name, AssetType::Texture, textureAsset);
+		}
+		ROSE_LOG("Packed %d textures into atlas page %d", (int)pageItems.size(), (int)pages.size() - 1);
+	}
+	for(auto& texture : pending)
+	{
+		SDL_FreeSurface(texture.second);
+	}
+}
+
+void AssetStore::FreeAtlasPages(const std::vector<SDL_Texture*>& pages)
+{
+	if(pages.empty())
+	{
+		return;
+	}
+	//Textures that were dropped from the package would otherwise keep drawing from a destroyed page
+	for(auto& slot : slots)
+	{
+		if(slot.handle.type != AssetType::Texture)
+		{
+			continue;
+		}
+		auto texture = (TextureAsset*)slot.handle.asset;
+		if(std::find(pages.begin(), pages.end(), texture->texture) != pages.end())
+		{
+			delete slot.handle.asset;
+			slot.handle = AssetHandle();
+			slot.generation++;
+		}
+	}
+	if(SDL_WasInit(0) != 0)
+	{
+		for(auto page : pages)
+		{
+			SDL_DestroyTexture(page);
+		}
 	}
 }
 
+void AssetStore::LoadAnimation(const std::string& assetId, const std::string& filePath)
+{
+	auto animation = AnimationImporter::LoadAnimation(filePath);
+	animation->textureId = GetAssetId(animation->texture);
+	SetAsset(assetId, AssetType::Animation, animation);
+}
+
 void AssetStore::LoadScript(const std::string& assetId, const std::string& filePath)
 {
 	FileResource fileHandle = FileResource(filePath);
@@ -74,52 +191,110 @@ void AssetStore::LoadScript(const std::string& assetId, const std::string& fileP
 	SDL_RWread(fileHandle.file, &fileString[0], sizeof(fileString[0]), fileString.size());
 
 	auto script = new ScriptAsset(fileString);
-	if(assets.find(assetId) != assets.end())
-	{
-		delete assets[assetId].asset;
-		assets[assetId].type = AssetType::Script;
-		assets[assetId].asset = script;
-		ROSE_LOG("Reloaded Script Asset %s", assetId.c_str());
-	} else
+	SetAsset(assetId, AssetType::Script, script);
+}
+
+void AssetStore::LoadPrefab(const std::string& assetId, const std::string& filePath)
+{
+	FileResource fileHandle = FileResource(filePath);
+	if(fileHandle.file == nullptr)
 	{
-		assets[assetId] = AssetHandle(AssetType::Script, script);
-		ROSE_LOG("Loaded New Script Asset %s", assetId.c_str());
+		ROSE_ERR("Couldn't load prefab %s", filePath.c_str());
+		return;
 	}
+	std::string fileString = std::string(SDL_RWsize(fileHandle.file), '\0');
+	SDL_RWread(fileHandle.file, &fileString[0], sizeof(fileString[0]), fileString.size());
+
+	SetAsset(assetId, AssetType::Prefab, new PrefabAsset(fileString));
 }
 
 AssetHandle AssetStore::GetAsset(const std::string& assetId) const
 {
-	if(assets.find(assetId) == assets.end())
+	auto index = assetIndices.find(assetId);
+	if(index == assetIndices.end())
 	{
 		return AssetHandle();
 	}
-	return assets.at(assetId);
+	return slots[index->second].handle;
+}
+
+std::uint32_t AssetStore::InternName(const std::string& assetId)
+{
+	auto index = assetIndices.find(assetId);
+	if(index == assetIndices.end())
+	{
+		index = assetIndices.emplace(assetId, (std::uint32_t)slots.size()).first;
+		slots.push_back(AssetSlot());
+	}
+	return index->second;
+}
+
+AssetId AssetStore::GetAssetId(const std::string& assetId)
+{
+	if(assetId == "")
+	{
+		return AssetId();
+	}
+	auto index = InternName(assetId);
+	return AssetId(index, slots[index].generation);
+}
+
+AssetHandle AssetStore::GetAsset(AssetId id) const
+{
+	if(id.index >= slots.size() || slots[id.index].generation != id.generation)
+	{
+		return AssetHandle();
+	}
+	return slots[id.index].handle;
+}
+
+AssetId AssetStore::GetCurrentId(AssetId id) const
+{
+	if(id.index >= slots.size())
+	{
+		return AssetId();
+	}
+	return AssetId(id.index, slots[id.index].generation);
 }
 
 std::vector<std::pair<std::string, AssetHandle>> AssetStore::GetAssetOfType(AssetType assetType) const
 {
 	std::vector<std::pair<std::string, AssetHandle>> list;
-	for(auto& asset : assets)
+	for(auto& asset : assetIndices)
 	{
-		if(asset.second.type == assetType)
+		if(slots[asset.second].handle.type == assetType)
 		{
-			list.push_back(asset);
+			list.push_back({asset.first, slots[asset.second].handle});
 		}
 	}
 	return list;
 }
 
-void AssetStore::LoadPackage(const std::string& filePath)
+void AssetStore::LoadPackage(const std::string& filePath, int atlasPageSize)
 {
 	auto pkg = new AssetPackage();
 	if(pkg->Load(filePath))
 	{
+		//Pages from a previous load of this package are freed once its textures are replaced
+		std::vector<SDL_Texture*> oldPages;
+		auto packagePages = atlasPages.find(filePath);
+		if(packagePages != atlasPages.end())
+		{
+			oldPages.swap(packagePages->second);
+			atlasPages.erase(packagePages);
+		}
+		std::vector<AssetFile*> atlasTextures;
 		for(auto assetFile : pkg->assets)
 		{
 			switch(assetFile->assetType)
 			{
 			case AssetType::Texture:
 			{
+				if(atlasPageSize > 0)
+				{
+					atlasTextures.push_back(assetFile);
+					break;
+				}
 				auto metaData = (TextureMetaData*)(assetFile->metaData);
 				AddTexture(metaData->name, assetFile->filePath, metaData->ppu);
 				break;
@@ -136,10 +311,21 @@ void AssetStore::LoadPackage(const std::string& filePath)
 				LoadAnimation(metaData->name, assetFile->filePath);
 				break;
 			}
+			case AssetType::Prefab:
+			{
+				auto metaData = (AssetMetaData*)(assetFile->metaData);
+				LoadPrefab(metaData->name, assetFile->filePath);
+				break;
+			}
 			default:
 				break;
 			}
 		}
+		if(!atlasTextures.empty())
+		{
+			PackTextures(atlasTextures, atlasPageSize, atlasPages[filePath]);
+		}
+		FreeAtlasPages(oldPages);
 		delete pkg;
 	} else
 	{
@@ -151,17 +337,9 @@ void AssetStore::LoadPackage(const std::string& filePath)
 AssetHandle AssetStore::NewAnimation(const std::string& assetId)
 {
 	auto animation = new Animation(32, 32, "", false);
-	if(assets.find(assetId) != assets.end())
-	{
-		delete assets[assetId].asset;
-		assets[assetId].type = AssetType::Animation;
-		assets[assetId].asset = animation;
-	} else
-	{
-		assets[assetId] = AssetHandle(AssetType::Animation, animation);
-	}
+	auto& handle = SetAsset(assetId, AssetType::Animation, animation);
 	ROSE_LOG("Created new Animation Asset %s", assetId.c_str());
-	return assets[assetId];
+	return handle;
 }
 
 void AssetStore::SaveAnimation(const std::string& assetId, const std::string& filePath)
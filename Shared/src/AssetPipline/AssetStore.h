@@ -8,10 +8,27 @@
 
 #include "Asset.h"
 
+struct AssetFile;
+
+struct AssetSlot
+{
+	AssetHandle handle;
+	std::uint32_t generation = 0;
+};
+
 class AssetStore
 {
 private:
-	std::map<std::string, AssetHandle> assets;
+	std::map<std::string, std::uint32_t> assetIndices;
+	std::vector<AssetSlot> slots;
+	//Atlas pages of each package file, replaced when the package is loaded again
+	std::map<std::string, std::vector<SDL_Texture*>> atlasPages;
+
+	std::uint32_t InternName(const std::string& assetId);
+	AssetHandle& SetAsset(const std::string& assetId, AssetType type, Asset* asset);
+	void PackTextures(const std::vector<AssetFile*>& textureFiles, int atlasPageSize, std::vector<SDL_Texture*>& pages);
+	//Unloads the textures still pointing into the pages, then destroys the pages
+	void FreeAtlasPages(const std::vector<SDL_Texture*>& pages);
 
 public:
 	AssetStore();
@@ -21,9 +38,17 @@ public:
 	void AddTexture(const std::string& assetId, const std::string& filePath, int ppu = 100);
 	void LoadAnimation(const std::string& assetId, const std::string& filePath);
 	void LoadScript(const std::string& assetId, const std::string& filePath);
+	void LoadPrefab(const std::string& assetId, const std::string& filePath);
 	AssetHandle GetAsset(const std::string& assetId) const;
+	//Interns the name, ids stay valid for names that are loaded later or reloaded
+	AssetId GetAssetId(const std::string& assetId);
+	//Empty when the asset was replaced or unloaded after the id was taken
+	AssetHandle GetAsset(AssetId id) const;
+	//Returns the id with the current generation of its asset
+	AssetId GetCurrentId(AssetId id) const;
 	std::vector<std::pair<std::string, AssetHandle>> GetAssetOfType(AssetType assetType) const;
-	void LoadPackage(const std::string& filePath);
+	//When atlasPageSize is above zero the package textures are packed into shared atlas pages of that size
+	void LoadPackage(const std::string& filePath, int atlasPageSize = 0);
 	AssetHandle NewAnimation(const std::string& assetId);
 	void SaveAnimation(const std::string& assetId, const std::string& filePath);
 };
\ No newline at end of file
@@ -0,0 +1,3 @@
+#include "PrefabAsset.h"
+
+PrefabAsset::PrefabAsset(const std::string& source) :source(source) {}
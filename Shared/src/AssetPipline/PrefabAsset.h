@@ -0,0 +1,10 @@
+#pragma once
+#include <string>
+
+#include "Asset.h"
+
+//Saved entity subtree in the level format, the engine compiles it into component copies when it is first used
+struct PrefabAsset : Asset {
+	std::string source;
+	PrefabAsset(const std::string& source);
+};
@@ -0,0 +1,119 @@
+#include "SkylinePacker.h"
+
+#include <climits>
+
+SkylinePacker::SkylinePacker(int width, int height)
+{
+	Reset(width, height);
+}
+
+void SkylinePacker::Reset(int width, int height)
+{
+	this->width = width;
+	this->height = height;
+	skyline.clear();
+	skyline.push_back({0, 0, width});
+}
+
+bool SkylinePacker::Fits(int index, int rectWidth, int rectHeight, int& y) const
+{
+	int x = skyline[index].x;
+	if(x + rectWidth > width)
+	{
+		return false;
+	}
+	y = 0;
+	int remaining = rectWidth;
+	while(remaining > 0)
+	{
+		if(index >= skyline.size())
+		{
+			return false;
+		}
+		if(skyline[index].y > y)
+		{
+			y = skyline[index].y;
+		}
+		if(y + rectHeight > height)
+		{
+			return false;
+		}
+		remaining -= skyline[index].width;
+		index++;
+	}
+	return true;
+}
+
+void SkylinePacker::AddSegment(int index, const SDL_Rect& rect)
+{
+	skyline.insert(skyline.begin() + index, {rect.x, rect.y + rect.h, rect.w});
+	for(int i = index + 1; i < skyline.size(); i++)
+	{
+		auto& previous = skyline[i - 1];
+		auto& segment = skyline[i];
+		int shrink = previous.x + previous.width - segment.x;
+		if(shrink <= 0)
+		{
+			break;
+		}
+		segment.x += shrink;
+		segment.width -= shrink;
+		if(segment.width > 0)
+		{
+			break;
+		}
+		skyline.erase(skyline.begin() + i);
+		i--;
+	}
+	for(int i = 0; i + 1 < skyline.size(); i++)
+	{
+		if(skyline[i].y == skyline[i + 1].y)
+		{
+			skyline[i].width += skyline[i + 1].width;
+			skyline.erase(skyline.begin() + i + 1);
+			i--;
+		}
+	}
+}
+
+bool SkylinePacker::Insert(int rectWidth, int rectHeight, SDL_Rect& result)
+{
+	int bestIndex = -1;
+	int bestTop = INT_MAX;
+	int bestWidth = INT_MAX;
+	for(int i = 0; i < skyline.size(); i++)
+	{
+		int y;
+		if(!Fits(i, rectWidth, rectHeight, y))
+		{
+			continue;
+		}
+		int top = y + rectHeight;
+		if(top < bestTop || (top == bestTop && skyline[i].width < bestWidth))
+		{
+			bestIndex = i;
+			bestTop = top;
+			bestWidth = skyline[i].width;
+			result = {skyline[i].x, y, rectWidth, rectHeight};
+		}
+	}
+	if(bestIndex == -1)
+	{
+		return false;
+	}
+	AddSegment(bestIndex, result);
+	return true;
+}
+
+int SkylinePacker::GetUsedHeight() const
+{
+	int usedHeight = 0;
+	for(auto& segment : skyline)
+	{
+		if(segment.y > usedHeight)
+		{
+			usedHeight = segment.y;
+		}
+	}
+	return usedHeight;
+}
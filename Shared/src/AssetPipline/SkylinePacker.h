@@ -0,0 +1,27 @@
+#pragma once
+#include <vector>
+
+#include <sdl2/SDL_rect.h>
+
+//Bottom-left skyline rectangle packer for a single fixed size page
+class SkylinePacker
+{
+	struct Segment
+	{
+		int x;
+		int y;
+		int width;
+	};
+
+	int width;
+	int height;
+	std::vector<Segment> skyline;
+
+	bool Fits(int index, int rectWidth, int rectHeight, int& y) const;
+	void AddSegment(int index, const SDL_Rect& rect);
+public:
+	SkylinePacker(int width = 0, int height = 0);
+	void Reset(int width, int height);
+	bool Insert(int rectWidth, int rectHeight, SDL_Rect& result);
+	int GetUsedHeight() const;
+};
@@ -1,9 +1,32 @@
 #include "TextureAsset.h"
 
 TextureAsset::~TextureAsset() {
-	if (texture != nullptr && SDL_WasInit(0) != 0) {
+	if (ownsTexture && texture != nullptr && SDL_WasInit(0) != 0) {
 		SDL_DestroyTexture(texture);
 	}
 }
 
-TextureAsset::TextureAsset(SDL_Texture* texture, int ppi) :texture(texture), ppu(ppi) {}
+TextureAsset::TextureAsset(SDL_Texture* texture, int ppi) :texture(texture), ppu(ppi) {
+	pageWidth = 0;
+	pageHeight = 0;
+	ownsTexture = true;
+	sortKey = 0;
+	if (texture != nullptr) {
+		SDL_QueryTexture(texture, nullptr, nullptr, &pageWidth, &pageHeight);
+	}
+	region = SDL_Rect{ 0, 0, pageWidth, pageHeight };
+	width = pageWidth;
+	height = pageHeight;
+}
+
+TextureAsset::TextureAsset(SDL_Texture* texture, int ppi, SDL_Rect region) :texture(texture), ppu(ppi), region(region) {
+	pageWidth = 0;
+	pageHeight = 0;
+	ownsTexture = false;
+	sortKey = 0;
+	if (texture != nullptr) {
+		SDL_QueryTexture(texture, nullptr, nullptr, &pageWidth, &pageHeight);
+	}
+	width = region.w;
+	height = region.h;
+}
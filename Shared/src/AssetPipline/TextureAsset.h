@@ -6,6 +6,16 @@
 struct TextureAsset : Asset {
 	SDL_Texture* texture;
 	const int ppu;
+	int width;
+	int height;
+	//Area of the texture used by this asset, a sub rectangle when the texture is a shared atlas page
+	SDL_Rect region;
+	int pageWidth;
+	int pageHeight;
+	bool ownsTexture;
+	//Stable id of the underlying texture for draw sorting, the asset index or the first asset index of an atlas page
+	std::uint32_t sortKey;
 	TextureAsset(SDL_Texture* texture, int ppi);
+	TextureAsset(SDL_Texture* texture, int ppi, SDL_Rect region);
 	~TextureAsset();
 };
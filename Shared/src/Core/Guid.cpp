@@ -1,10 +1,40 @@
 #include "Guid.h"
 
-std::random_device GuidGenerator::rd;
-std::mt19937_64 GuidGenerator::gen;
-std::uniform_int_distribution<Guid> GuidGenerator::dis;
+#include <random>
+
+//SplitMix64, a counter run through a mixing function so every step is a full 64 bit permutation
+struct GuidState {
+	std::uint64_t state;
+
+	GuidState() {
+		std::random_device rd;
+		state = (std::uint64_t(rd()) << 32) ^ rd();
+	}
+	Guid Next() {
+		std::uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+		return z ^ (z >> 31);
+	}
+};
+
+static thread_local GuidState generator;
 
 Guid GuidGenerator::New() {
-	gen = std::mt19937_64(rd());
-	return dis(gen);
+	Guid guid;
+	do {
+		guid = generator.Next();
+	} while(guid == Guid(-1));
+	return guid;
+}
+
+void GuidGenerator::New(Guid* out, int count) {
+	auto& state = generator;
+	for(int i = 0; i < count; i++) {
+		Guid guid;
+		do {
+			guid = state.Next();
+		} while(guid == Guid(-1));
+		out[i] = guid;
+	}
 }
@@ -1,13 +1,11 @@
 #pragma once
-#include <random>
+#include <cstdint>
 
 typedef std::uint64_t Guid;
 
 class GuidGenerator {
-
-	static std::random_device rd;
-	static std::mt19937_64 gen;
-	static std::uniform_int_distribution<Guid> dis;
 public:
+	//Each thread has its own generator seeded once from std::random_device, -1 is never returned since it means no entity
 	static Guid New();
-};
\ No newline at end of file
+	static void New(Guid* out, int count);
+};
@@ -1,7 +1,20 @@
 #include "SdlContainer.h"
 
-SdlContainer::SdlContainer(int windowWidth, int windowHeight, std::string windowName)
+#include <sdl2/SDL_image.h>
+
+SdlContainer::SdlContainer(int windowWidth, int windowHeight, std::string windowName, bool headless)
 {
+	window = nullptr;
+	surface = nullptr;
+	if (headless) {
+		if (!SDL_WasInit(0)) {
+			SDL_Init(SDL_INIT_TIMER | SDL_INIT_EVENTS);
+		}
+		surface = SDL_CreateRGBSurfaceWithFormat(0, windowWidth, windowHeight, 32, SDL_PIXELFORMAT_RGBA32);
+		renderer = SDL_CreateSoftwareRenderer(surface);
+		SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "0");
+		return;
+	}
 	if (!SDL_WasInit(0)) {
 		SDL_Init(SDL_INIT_EVERYTHING);
 	}
@@ -20,7 +33,12 @@ SdlContainer::SdlContainer(int windowWidth, int windowHeight, std::string window
 SdlContainer::~SdlContainer()
 {
 	SDL_DestroyRenderer(renderer);
-	SDL_DestroyWindow(window);
+	if (window != nullptr) {
+		SDL_DestroyWindow(window);
+	}
+	if (surface != nullptr) {
+		SDL_FreeSurface(surface);
+	}
 	SDL_Quit();
 }
 
@@ -36,6 +54,9 @@ SDL_Window* SdlContainer::GetWindow()
 
 glm::ivec2 SdlContainer::GetWindowSize()
 {
+	if (surface != nullptr) {
+		return glm::ivec2(surface->w, surface->h);
+	}
 	int width, height;
 	SDL_GetWindowSize(window, &width, &height);
 	return glm::ivec2(width, height);
@@ -61,3 +82,22 @@ bool SdlContainer::ProcessEvents()
 	}
 	return exit;
 }
+
+bool SdlContainer::IsHeadless() const
+{
+	return surface != nullptr;
+}
+
+bool SdlContainer::SaveFrame(const std::string& filePath)
+{
+	if (surface != nullptr) {
+		return IMG_SavePNG(surface, filePath.c_str()) == 0;
+	}
+	int width, height;
+	SDL_GetRendererOutputSize(renderer, &width, &height);
+	SDL_Surface* frame = SDL_CreateRGBSurfaceWithFormat(0, width, height, 32, SDL_PIXELFORMAT_RGBA32);
+	bool saved = SDL_RenderReadPixels(renderer, nullptr, SDL_PIXELFORMAT_RGBA32, frame->pixels, frame->pitch) == 0
+		&& IMG_SavePNG(frame, filePath.c_str()) == 0;
+	SDL_FreeSurface(frame);
+	return saved;
+}
@@ -9,12 +9,16 @@ class SdlContainer
 private:
 	SDL_Window* window;
 	SDL_Renderer* renderer;
+	//Render target of the software renderer when running headless
+	SDL_Surface* surface;
 public:
-	SdlContainer(int windowWidth, int windowHeight, std::string windowName = "Rose Engine");
+	SdlContainer(int windowWidth, int windowHeight, std::string windowName = "Rose Engine", bool headless = false);
 	~SdlContainer();
 	SDL_Renderer* GetRenderer();
 	SDL_Window* GetWindow();
 	glm::ivec2 GetWindowSize();
 	bool ProcessEvents();
+	bool IsHeadless() const;
+	bool SaveFrame(const std::string& filePath);
 };
 
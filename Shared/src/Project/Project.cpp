@@ -9,9 +9,35 @@
 #include "../Core/Systems.h"
 #include "../FileDialog.h"
 
+static void DeserializePhysics(ryml::NodeRef node, PhysicsSettings& settings)
+{
+	if (node.has_child("TickRate")) {
+		node["TickRate"] >> settings.tickRate;
+	}
+	if (node.has_child("MaxSubsteps")) {
+		node["MaxSubsteps"] >> settings.maxSubsteps;
+	}
+	if (node.has_child("VelocityIterations")) {
+		node["VelocityIterations"] >> settings.velocityIterations;
+	}
+	if (node.has_child("PositionIterations")) {
+		node["PositionIterations"] >> settings.positionIterations;
+	}
+}
+
+static void SerializePhysics(ryml::NodeRef node, const PhysicsSettings& settings)
+{
+	node |= ryml::MAP;
+	node["TickRate"] << settings.tickRate;
+	node["MaxSubsteps"] << settings.maxSubsteps;
+	node["VelocityIterations"] << settings.velocityIterations;
+	node["PositionIterations"] << settings.positionIterations;
+}
+
 Project::Project(ryml::NodeRef& node)
 {
 	startLevel = -1;
+	atlasPageSize = 0;
 	if (node.has_child("Levels")) {
 		auto levels = node["Levels"];
 		auto child = levels.first_child();
@@ -35,11 +61,32 @@ Project::Project(ryml::NodeRef& node)
 	if (node.has_child("StartLevel")) {
 		node["StartLevel"] >> startLevel;
 	}
+	if (node.has_child("AtlasPageSize")) {
+		node["AtlasPageSize"] >> atlasPageSize;
+	}
+	if (node.has_child("Physics")) {
+		DeserializePhysics(node["Physics"], physicsSettings);
+	}
+	if (node.has_child("LevelPhysics")) {
+		auto levels = node["LevelPhysics"];
+		auto child = levels.first_child();
+		for (int i = 0; i < levels.num_children(); i++) {
+			if (child.has_child("Level")) {
+				std::string levelName;
+				child["Level"] >> levelName;
+				auto settings = physicsSettings;
+				DeserializePhysics(child, settings);
+				levelPhysicsSettings[levelName] = settings;
+			}
+			child = child.next_sibling();
+		}
+	}
 }
 
 Project::Project()
 {
 	startLevel = -1;
+	atlasPageSize = 0;
 }
 
 void Project::Serialize(ryml::NodeRef& node)
@@ -71,6 +118,22 @@ void Project::Serialize(ryml::NodeRef& node)
 	if (startLevel != -1) {
 		node["StartLevel"] << startLevel;
 	}
+	if (atlasPageSize > 0) {
+		node["AtlasPageSize"] << atlasPageSize;
+	}
+	auto physics = node.append_child();
+	physics.set_key("Physics");
+	SerializePhysics(physics, physicsSettings);
+	if (!levelPhysicsSettings.empty()) {
+		auto levelPhysics = node.append_child();
+		levelPhysics.set_key("LevelPhysics");
+		levelPhysics |= ryml::SEQ;
+		for (auto& level : levelPhysicsSettings) {
+			auto child = levelPhysics.append_child();
+			SerializePhysics(child, level.second);
+			child["Level"] << level.first;
+		}
+	}
 }
 
 void Project::AddPackage(std::string file)
@@ -119,6 +182,28 @@ const int Project::GetStartLevel() const
 	return startLevel;
 }
 
+void Project::SetAtlasPageSize(int size)
+{
+	atlasPageSize = size < 0 ? 0 : size;
+}
+
+const int Project::GetAtlasPageSize() const
+{
+	return atlasPageSize;
+}
+
+const PhysicsSettings& Project::GetPhysicsSettings(std::string file) const
+{
+	if (file != "") {
+		auto relativePath = ROSE_GETSYSTEM(FileDialog).GetRelativePath(std::filesystem::current_path().string(), file);
+		auto level = levelPhysicsSettings.find(relativePath);
+		if (level != levelPhysicsSettings.end()) {
+			return level->second;
+		}
+	}
+	return physicsSettings;
+}
+
 const std::list<std::string>& Project::GetPkgFiles() const
 {
 	return pksFiles;
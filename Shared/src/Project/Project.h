@@ -1,12 +1,24 @@
 #pragma once
 #include <list>
+#include <map>
 #include <string>
 #include <ryml/ryml.hpp>
 
+//Fixed step physics configuration, the project has defaults and levels can override them
+struct PhysicsSettings {
+	int tickRate = 60;
+	int maxSubsteps = 4;
+	int velocityIterations = 10;
+	int positionIterations = 12;
+};
+
 class Project {
 	std::list<std::string> pksFiles;
 	std::list<std::string> levelFiles;
 	int startLevel;
+	int atlasPageSize;
+	PhysicsSettings physicsSettings;
+	std::map<std::string, PhysicsSettings> levelPhysicsSettings;
 
 public:
 	Project(ryml::NodeRef& node);
@@ -18,6 +30,10 @@ public:
 	void RemoveLevel(std::string file);
 	void SetStartLevel(int level);
 	const int GetStartLevel() const;
+	void SetAtlasPageSize(int size);
+	const int GetAtlasPageSize() const;
+	//Settings of the level when it overrides them, otherwise the project defaults
+	const PhysicsSettings& GetPhysicsSettings(std::string file = "") const;
 	const std::list<std::string>& GetPkgFiles() const;
 	std::string GetPkgFile(int index) const;
 	const std::list<std::string>& GetLevelFiles() const;
@@ -40,7 +40,7 @@ Project* ProjectLoader::LoadProject(const std::string& fileName)
 	loadedProject = project;
 	loadedProjectPath = fileName;
 	for (auto& pkg : loadedProject->GetPkgFiles()) {
-		assetStore->LoadPackage(pkg);
+		assetStore->LoadPackage(pkg, loadedProject->GetAtlasPageSize());
 	}
 	return loadedProject;
 }
@@ -0,0 +1,173 @@
+#include "AffineTests.h"
+
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "Core/Affine.h"
+
+const float TOLERANCE = 1e-4f;
+
+struct TRS
+{
+	glm::vec2 position;
+	glm::vec2 scale;
+	float rotation;
+};
+
+//Negative scales are mirrored sprites, rotations near 0 and 360 wrap in the editor
+static const TRS CASES[] = {
+	{{0, 0}, {1, 1}, 0},
+	{{3.5f, -2}, {1, 1}, 360},
+	{{-7, 4}, {2, 0.5f}, 0.001f},
+	{{1, 1}, {-1, 1}, 359.999f},
+	{{10, -10}, {-2, -3}, -0.001f},
+	{{-0.25f, 8}, {1, -1}, 180},
+	{{100, 50}, {0.1f, 4}, 90},
+	{{-3, -3}, {-0.5f, 2}, 270},
+	{{2, 0}, {3, 3}, 45},
+	{{0, -6}, {1.5f, -0.75f}, 359.5f},
+	{{5, 5}, {-4, -4}, 0.5f},
+};
+static const int CASE_COUNT = sizeof(CASES) / sizeof(CASES[0]);
+
+static bool IsNear(float a, float b)
+{
+	return std::fabs(a - b) <= TOLERANCE * (1 + std::fabs(b));
+}
+
+static bool IsNear(const glm::mat3& a, const glm::mat3& b)
+{
+	for(int c = 0; c < 3; c++)
+	{
+		for(int r = 0; r < 3; r++)
+		{
+			if(!IsNear(a[c][r], b[c][r]))
+			{
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+//The glm path of TransformComponent::MakeLocalMatrix, kept here so the tests do not link the engine
+static glm::mat3 MakeMatrix(const TRS& trs)
+{
+	auto matT = glm::mat3(
+		1, 0, trs.position.x,
+		0, 1, trs.position.y,
+		0, 0, 1
+	);
+	auto cosT = std::cos(glm::radians(trs.rotation));
+	auto sinT = std::sin(glm::radians(trs.rotation));
+	auto matR = glm::mat3(
+		cosT, -sinT, 0,
+		sinT, cosT, 0,
+		0, 0, 1
+	);
+	auto matS = glm::mat3(
+		trs.scale.x, 0, 0,
+		0, trs.scale.y, 0,
+		0, 0, 1
+	);
+	return matS * matR * matT;
+}
+
+static void Check(bool passed, const char* check, int a, int b, int& failures)
+{
+	if(!passed)
+	{
+		std::printf("Affine test %s failed for cases %d, %d\n", check, a, b);
+		failures++;
+	}
+}
+
+static void TestSingle(int& failures)
+{
+	for(int i = 0; i < CASE_COUNT; i++)
+	{
+		auto matrix = MakeMatrix(CASES[i]);
+		auto affine = Affine::FromTRS(CASES[i].position, CASES[i].scale, CASES[i].rotation);
+		Check(IsNear(affine.ToMat3(), matrix), "FromTRS", i, i, failures);
+		Check(IsNear(Affine(matrix).ToMat3(), matrix), "ToMat3", i, i, failures);
+		Check(IsNear((affine * affine.Inverse()).ToMat3(), glm::mat3(1)), "Inverse", i, i, failures);
+
+		auto point = glm::vec2(1.5f, -2.5f);
+		auto expected = glm::vec3(point, 1) * matrix;
+		auto applied = affine.Apply(point);
+		Check(IsNear(applied.x, expected.x) && IsNear(applied.y, expected.y), "Apply", i, i, failures);
+		for(int j = 0; j < CASE_COUNT; j++)
+		{
+			auto other = MakeMatrix(CASES[j]);
+			auto product = affine * Affine(other);
+			Check(IsNear(product.ToMat3(), matrix * other), "Multiply", i, j, failures);
+		}
+	}
+}
+
+//Every count from 1 to 9 covers full SSE blocks of 4 and the scalar tail
+static void TestBatches(int& failures)
+{
+	for(int count = 1; count <= 9; count++)
+	{
+		std::vector<Affine> locals(count);
+		std::vector<Affine> parents(count);
+		std::vector<Affine> composed(count);
+		std::vector<Affine> sharedParent(count);
+		std::vector<glm::vec2> extents(count);
+		std::vector<float> corners(count * 8);
+		for(int i = 0; i < count; i++)
+		{
+			locals[i] = Affine(MakeMatrix(CASES[i % CASE_COUNT]));
+			parents[i] = Affine(MakeMatrix(CASES[(i * 3 + 1) % CASE_COUNT]));
+			extents[i] = glm::vec2(0.5f + i, 1.5f - i * 0.25f);
+		}
+		ComposeAffines(locals.data(), parents.data(), composed.data(), count);
+		ComposeAffines(locals.data(), parents[0], sharedParent.data(), count);
+		TransformQuads(composed.data(), extents.data(), corners.data(), count);
+		for(int i = 0; i < count; i++)
+		{
+			auto world = MakeMatrix(CASES[i % CASE_COUNT]) * MakeMatrix(CASES[(i * 3 + 1) % CASE_COUNT]);
+			Check(IsNear(composed[i].ToMat3(), world), "ComposeAffines", count, i, failures);
+			Check(IsNear(sharedParent[i].ToMat3(), MakeMatrix(CASES[i % CASE_COUNT]) * MakeMatrix(CASES[1])), "ComposeAffines shared parent", count, i, failures);
+			glm::vec2 quad[] = {
+				{-extents[i].x, extents[i].y},
+				{extents[i].x, extents[i].y},
+				{extents[i].x, -extents[i].y},
+				{-extents[i].x, -extents[i].y},
+			};
+			for(int v = 0; v < 4; v++)
+			{
+				auto expected = glm::vec3(quad[v], 1) * world;
+				Check(IsNear(corners[i * 8 + v * 2], expected.x) && IsNear(corners[i * 8 + v * 2 + 1], expected.y), "TransformQuads", count, i, failures);
+			}
+		}
+
+		std::vector<float> positions(count * 2);
+		std::vector<float> transformed(count * 2);
+		for(int i = 0; i < count * 2; i++)
+		{
+			positions[i] = i * 0.75f - 3;
+		}
+		TransformPositions(composed[0], positions.data(), transformed.data(), count);
+		auto matrix = composed[0].ToMat3();
+		for(int i = 0; i < count; i++)
+		{
+			auto expected = glm::vec3(glm::vec2(positions[i * 2], positions[i * 2 + 1]), 1) * matrix;
+			Check(IsNear(transformed[i * 2], expected.x) && IsNear(transformed[i * 2 + 1], expected.y), "TransformPositions", count, i, failures);
+		}
+	}
+}
+
+int RunAffineTests()
+{
+	int failures = 0;
+	TestSingle(failures);
+	TestBatches(failures);
+	if(failures == 0)
+	{
+		std::printf("Affine tests passed\n");
+	}
+	return failures;
+}
@@ -0,0 +1,4 @@
+#pragma once
+
+//Checks Affine and its batch kernels against the glm::mat3 math of TransformComponent::MakeLocalMatrix, returns the number of failed checks
+int RunAffineTests();
@@ -0,0 +1,15 @@
+#include <cstdio>
+
+#include "AffineTests.h"
+
+//Exits with the number of failed checks so a build can fail on it
+int main(int argc, char* argv[])
+{
+	int failures = 0;
+	failures += RunAffineTests();
+	if(failures > 0)
+	{
+		std::printf("%d checks failed\n", failures);
+	}
+	return failures;
+}